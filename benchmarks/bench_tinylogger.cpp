@@ -0,0 +1,261 @@
+#include <benchmark/benchmark.h>
+
+#include <tinylogger/tinylogger.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+/*
+ * This file is built as several executables, one per configuration of the
+ * header: the default one, IS_TINYLOGGER_INLINED set to 1, the macros
+ * stripped with MAX_LOG_LEVEL_AT_COMPILATION set to 3 (WARNING), and the
+ * backend compiled by the tinylogger library (TINYLOGGER_COMPILED). Records
+ * are logged at the WARNING level, so that they are printed in every build.
+ *
+ * Throughput benchmarks report the mean time of a call, latency benchmarks
+ * time every call on its own and report percentiles, that include the cost
+ * of reading the clock twice.
+ */
+
+
+namespace {
+
+    // Discards the lines, so that only the cost of the logger is measured
+    class NullSink : public tl::Sink {
+    public:
+        void write(LogLevel, std::string_view line) override {
+            benchmark::DoNotOptimize(line.data());
+        }
+    };
+
+    // Argument mixes, every one logging a single record
+    struct Disabled {
+        static void log(int i) { LOG_DEBUG("disabled record ", i, ' ', 1.5); (void)i; }
+    };
+
+    struct TextOnly {
+        static void log(int)   { LOG_WARNING("constant message without any argument"); }
+    };
+
+    struct Integers {
+        static void log(int i) { LOG_WARNING("integers ", i, ' ', i * 3, ' ', static_cast<uint64_t>(i) << 20); }
+    };
+
+    struct Floating {
+        static void log(int i) { LOG_WARNING("floating ", i * 0.5, ' ', static_cast<float>(i) / 3.0f); }
+    };
+
+    struct Strings {
+        static void log(int i) {
+            static const std::string owned("owned string");
+            LOG_WARNING("strings ", owned, ' ', std::string_view("viewed string"), ' ', i);
+        }
+    };
+
+    // Too large for the payload of a record, stored on the heap or in the arena
+    struct LongStrings {
+        static void log(int i) {
+            static const std::string owned(512, 'x');
+            LOG_WARNING("long string ", owned, ' ', i);
+        }
+    };
+
+    struct Mixed {
+        static void log(int i) { LOG_WARNING("request ", i, " served in ", i * 0.25, " ms by ", "worker", ' ', i % 8 == 0); }
+    };
+
+    struct Formatted {
+        static void log(int i) { LOG_WARNINGF("request {} served in {:.2f} ms by {:>8}", i, i * 0.25, "worker"); }
+    };
+
+    struct Structured {
+        static void log(int i) { LOG_WARNING_KV("request served", tl::kv("request", i), tl::kv("ms", i * 0.25), tl::kv("worker", "worker")); }
+    };
+
+    // Logging paths, configuring the global logger before a benchmark runs
+    struct Sync {
+        static void setUp(const benchmark::State&) {
+            logger.clearSinks();
+            logger.addSink(std::make_shared<NullSink>());
+            logger.setLogLevel(LogLevel::WARNING);
+        }
+
+        static void tearDown(const benchmark::State&) {}
+    };
+
+    struct Async {
+        static void setUp(const benchmark::State& state) {
+            Sync::setUp(state);
+            logger.startAsync();
+        }
+
+        static void tearDown(const benchmark::State&) {
+            logger.flush();
+            logger.stopAsync();
+        }
+    };
+
+    struct AsyncArena {
+        static void setUp(const benchmark::State& state) {
+            Sync::setUp(state);
+            AsyncOptions options;
+            options.arenaCapacity = 16 * 1024 * 1024;
+            logger.startAsync(options);
+        }
+
+        static void tearDown(const benchmark::State& state) {
+            Async::tearDown(state);
+        }
+    };
+
+    struct ThreadQueues {
+        static void setUp(const benchmark::State& state) {
+            Sync::setUp(state);
+            AsyncOptions options;
+            options.threadQueues = true;
+            logger.startAsync(options);
+        }
+
+        static void tearDown(const benchmark::State& state) {
+            Async::tearDown(state);
+        }
+    };
+
+    // Records of the disabled level kept in the ring of the thread, without being written
+    struct Backtrace {
+        static void setUp(const benchmark::State& state) {
+            Sync::setUp(state);
+            logger.enableBacktrace();
+        }
+
+        static void tearDown(const benchmark::State&) {
+            logger.disableBacktrace();
+        }
+    };
+
+    struct Binary {
+        static std::filesystem::path path() {
+            return std::filesystem::temp_directory_path() / "tinylogger_bench.tlb";
+        }
+
+        static void setUp(const benchmark::State&) {
+            logger.clearSinks();
+            logger.addSink(std::make_shared<tl::BinaryFileSink>(path()));
+            logger.setLogLevel(LogLevel::WARNING);
+        }
+
+        static void tearDown(const benchmark::State&) {
+            logger.flush();
+            logger.clearSinks();
+            std::filesystem::remove(path());
+        }
+    };
+
+    template <typename Path, typename Mix>
+    void BM_Throughput(benchmark::State& state) {
+        int i = 0;
+        for (auto _ : state)
+            Mix::log(i++);
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    template <typename Path, typename Mix>
+    void BM_Latency(benchmark::State& state) {
+        using Clock = std::chrono::steady_clock;
+
+        std::vector<int64_t> samples;
+        samples.reserve(1 << 20);
+
+        int i = 0;
+        for (auto _ : state) {
+            const Clock::time_point start = Clock::now();
+            Mix::log(i++);
+            const Clock::time_point end   = Clock::now();
+            samples.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+        }
+        state.SetItemsProcessed(state.iterations());
+
+        if (samples.empty())
+            return;
+        std::sort(samples.begin(), samples.end());
+        const auto percentile = [&samples](double rank) {
+            const size_t index = std::min(samples.size() - 1, static_cast<size_t>(rank * static_cast<double>(samples.size())));
+            return benchmark::Counter(static_cast<double>(samples[index]), benchmark::Counter::kAvgThreads);
+        };
+        state.counters["p50_ns"]   = percentile(0.50);
+        state.counters["p90_ns"]   = percentile(0.90);
+        state.counters["p99_ns"]   = percentile(0.99);
+        state.counters["p99.9_ns"] = percentile(0.999);
+        state.counters["max_ns"]   = benchmark::Counter(static_cast<double>(samples.back()), benchmark::Counter::kAvgThreads);
+    }
+
+    const int maxThreads = static_cast<int>(std::max(2u, std::thread::hardware_concurrency()));
+
+} // namespace
+
+
+// Registers a benchmark, with the setup and teardown of its logging path
+#define TL_BENCHMARK(benchmark, path, mix) \
+    BENCHMARK_TEMPLATE(benchmark, path, mix)->Setup(path::setUp)->Teardown(path::tearDown)
+
+// Disabled level: runtime check, or empty macro in the stripped build
+TL_BENCHMARK(BM_Throughput, Sync, Disabled);
+TL_BENCHMARK(BM_Latency,    Sync, Disabled);
+
+// Synchronous logging, formatted on the caller thread under the log mutex
+TL_BENCHMARK(BM_Throughput, Sync, TextOnly);
+TL_BENCHMARK(BM_Throughput, Sync, Integers);
+TL_BENCHMARK(BM_Throughput, Sync, Floating);
+TL_BENCHMARK(BM_Throughput, Sync, Strings );
+TL_BENCHMARK(BM_Throughput, Sync, Mixed   );
+TL_BENCHMARK(BM_Throughput, Sync, Formatted);
+TL_BENCHMARK(BM_Throughput, Sync, Structured);
+TL_BENCHMARK(BM_Latency,    Sync, Mixed   );
+
+// Contention of several threads on the log mutex
+TL_BENCHMARK(BM_Throughput, Sync, Mixed)->ThreadRange(2, maxThreads)->UseRealTime();
+TL_BENCHMARK(BM_Latency,    Sync, Mixed)->ThreadRange(2, maxThreads)->UseRealTime();
+
+// Asynchronous logging, formatted by the backend thread
+TL_BENCHMARK(BM_Throughput, Async, Integers);
+TL_BENCHMARK(BM_Throughput, Async, Formatted);
+TL_BENCHMARK(BM_Throughput, Async, Structured);
+TL_BENCHMARK(BM_Throughput, Async, LongStrings);
+TL_BENCHMARK(BM_Throughput, Async, Mixed   )->ThreadRange(1, maxThreads)->UseRealTime();
+TL_BENCHMARK(BM_Latency,    Async, Mixed   )->ThreadRange(1, maxThreads)->UseRealTime();
+
+// Records too large for their payload, stored in the arena instead of the heap
+TL_BENCHMARK(BM_Throughput, AsyncArena, LongStrings)->ThreadRange(1, maxThreads)->UseRealTime();
+TL_BENCHMARK(BM_Latency,    AsyncArena, LongStrings);
+
+// Asynchronous logging, with a queue per thread merged by the backend
+TL_BENCHMARK(BM_Throughput, ThreadQueues, Mixed)->ThreadRange(1, maxThreads)->UseRealTime();
+TL_BENCHMARK(BM_Latency,    ThreadQueues, Mixed)->ThreadRange(1, maxThreads)->UseRealTime();
+
+// Disabled level recorded for the next error, stripped in the stripped build
+TL_BENCHMARK(BM_Throughput, Backtrace, Disabled);
+TL_BENCHMARK(BM_Latency,    Backtrace, Disabled);
+
+// Binary records, without any text rendering
+TL_BENCHMARK(BM_Throughput, Binary, Mixed);
+TL_BENCHMARK(BM_Latency,    Binary, Mixed);
+
+
+int main(int argc, char** argv) {
+    benchmark::AddCustomContext("IS_TINYLOGGER_INLINED",        std::to_string(IS_TINYLOGGER_INLINED));
+    benchmark::AddCustomContext("MAX_LOG_LEVEL_AT_COMPILATION", std::to_string(MAX_LOG_LEVEL_AT_COMPILATION));
+    benchmark::AddCustomContext("TINYLOGGER_COMPILED",          std::to_string(TINYLOGGER_COMPILED));
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+        return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,29 @@
+#include <tinylogger/tinylogger.hpp>
+
+#include <string>
+
+
+/*
+ * Not run: this file is built as two objects, one including the header alone
+ * and one linked with the tinylogger library (TINYLOGGER_COMPILED set to 1),
+ * to compare the code generated for a hundred call sites, and the time taken
+ * to build them:
+ *
+ *     size CMakeFiles/tinylogger_call_sites*.dir/call_sites.cpp.o
+ */
+
+
+// Four call sites of the usual mixes of arguments
+#define TL_CALL_SITES(n)                                   \
+    LOG_INFO("site " #n " ", i, " ", d);                   \
+    LOG_WARNING("site " #n " ", s, ' ', i + n);            \
+    LOG_DEBUG("site " #n " ", d * n, " ms");               \
+    LOG_ERROR("site " #n " ", i, ' ', d, ' ', s, ' ', n##u)
+
+void callSites(int i, double d, const std::string& s) {
+    TL_CALL_SITES(0);  TL_CALL_SITES(1);  TL_CALL_SITES(2);  TL_CALL_SITES(3);  TL_CALL_SITES(4);
+    TL_CALL_SITES(5);  TL_CALL_SITES(6);  TL_CALL_SITES(7);  TL_CALL_SITES(8);  TL_CALL_SITES(9);
+    TL_CALL_SITES(10); TL_CALL_SITES(11); TL_CALL_SITES(12); TL_CALL_SITES(13); TL_CALL_SITES(14);
+    TL_CALL_SITES(15); TL_CALL_SITES(16); TL_CALL_SITES(17); TL_CALL_SITES(18); TL_CALL_SITES(19);
+    TL_CALL_SITES(20); TL_CALL_SITES(21); TL_CALL_SITES(22); TL_CALL_SITES(23); TL_CALL_SITES(24);
+}
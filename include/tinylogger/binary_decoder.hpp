@@ -0,0 +1,229 @@
+#pragma once
+
+
+/*
+ * ============================================================================
+ *                       TinyLogger Binary Decoder Header
+ * ============================================================================
+ *
+ * Turns binary logs, as written by tl::BinaryFileSink, back into the lines a
+ * text sink would have written. It is used by the tinylogger_decode tool and
+ * is not needed by programs that only write logs.
+ */
+
+
+#include <tinylogger/tinylogger.hpp>
+
+#include <algorithm>
+#include <istream>
+#include <ostream>
+
+
+namespace tl {
+namespace detail {
+
+    // Reads the binary log entries from a stream, failing on truncation
+    class BinaryReader {
+    public:
+        explicit BinaryReader(std::istream& input) : input_(input) {}
+
+        bool readByte(char& value) {
+            return static_cast<bool>(input_.get(value));
+        }
+
+        bool readVarint(uint64_t& value) {
+            value = 0;
+            for (int shift = 0; shift < 64; shift += 7) {
+                char byte;
+                if (!readByte(byte))
+                    return false;
+                value |= static_cast<uint64_t>(static_cast<unsigned char>(byte) & 0x7F) << shift;
+                if (!(static_cast<unsigned char>(byte) & 0x80))
+                    return true;
+            }
+            return false;
+        }
+
+        bool readFixed(uint64_t& value, int size) {
+            value = 0;
+            for (int i = 0; i < size; ++i) {
+                char byte;
+                if (!readByte(byte))
+                    return false;
+                value |= static_cast<uint64_t>(static_cast<unsigned char>(byte)) << (8 * i);
+            }
+            return true;
+        }
+
+        // Read by chunks, so that a corrupt size fails at the end of the stream
+        // instead of allocating it
+        bool readString(std::string& value) {
+            uint64_t size;
+            if (!readVarint(size))
+                return false;
+
+            value.clear();
+            char chunk[4096];
+            while (size > 0) {
+                const size_t count = static_cast<size_t>(std::min<uint64_t>(size, sizeof(chunk)));
+                if (!input_.read(chunk, static_cast<std::streamsize>(count)))
+                    return false;
+                value.append(chunk, count);
+                size -= count;
+            }
+            return true;
+        }
+
+    private:
+        std::istream& input_;
+    };
+
+} // namespace detail
+
+
+    /*
+     * @brief Decodes a binary log, and writes it as text lines.
+     *
+     * The elapsed time of every line is computed from the previous record
+     * of the log, the first one of every session having an elapsed time of
+     * zero.
+     *
+     * @param input     Stream opened in binary mode on the binary log.
+     * @param output    Stream receiving the text lines.
+     * @param format    Layout of the timestamps, see TimestampFormat.
+     * @param precision Number of sub-second digits, see TimestampPrecision.
+     *
+     * @return false if the input is not a binary log, or is truncated.
+     */
+    inline bool decodeBinaryLog(std::istream& input, std::ostream& output,
+                                TimestampFormat    format    = TimestampFormat::CTIME,
+                                TimestampPrecision precision = TimestampPrecision::SECONDS) {
+        detail::BinaryReader reader(input);
+        detail::FormatBuffer buffer;
+        detail::TimestampCache timestampCache;
+
+        std::unordered_map<uint64_t, std::string> strings;
+        std::unordered_map<uint64_t, LogLevel>    callSites;
+        int64_t                                   lastTime    = 0;
+        bool                                      isInSession = false;
+
+        const std::string_view sessionTag(binary::sessionTag, sizeof(binary::sessionTag) - 1);
+
+        char tag;
+        while (reader.readByte(tag)) {
+            if (tag == sessionTag[0]) {
+                std::string magic(sessionTag.size() - 1, '\0');
+                if (!input.read(&magic[0], static_cast<std::streamsize>(magic.size())) || magic != sessionTag.substr(1))
+                    return false;
+
+                strings.clear();
+                callSites.clear();
+                isInSession = true;
+                lastTime    = 0;
+                continue;
+            }
+            if (!isInSession)
+                return false;
+
+            uint64_t id;
+            if (tag == binary::stringTag) {
+                if (!reader.readVarint(id) || !reader.readString(strings[id]))
+                    return false;
+            }
+            else if (tag == binary::callSiteTag) {
+                char level;
+                if (!reader.readVarint(id) || !reader.readByte(level))
+                    return false;
+                callSites[id] = static_cast<LogLevel>(level);
+            }
+            else if (tag == binary::recordTag) {
+                uint64_t time, argumentCount;
+                if (!reader.readVarint(id) || !reader.readFixed(time, 8) || !reader.readVarint(argumentCount))
+                    return false;
+
+                const int64_t microseconds = static_cast<int64_t>(time);
+                const auto    timePoint    = std::chrono::system_clock::time_point(
+                    std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::microseconds(microseconds)));
+
+                char header[96];
+                const std::string_view timestamp = timestampCache.render(timePoint, format, precision);
+                char* cursor = std::copy(timestamp.begin(), timestamp.end(), header);
+                cursor       = detail::writeElapsed(cursor, lastTime ? microseconds - lastTime : 0, precision);
+                lastTime     = microseconds;
+
+                buffer.clear();
+                buffer.append(detail::levelLabel(callSites[id]));
+                buffer.append(std::string_view(header, static_cast<size_t>(cursor - header)));
+
+                for (uint64_t i = 0; i < argumentCount; ++i) {
+                    char        argumentTag;
+                    uint64_t    value;
+                    std::string text;
+                    if (!reader.readByte(argumentTag))
+                        return false;
+
+                    switch (argumentTag) {
+                        case 'b':
+                        case 'c': {
+                            char byte;
+                            if (!reader.readByte(byte))
+                                return false;
+                            if (argumentTag == 'b')
+                                detail::appendArgument(buffer, byte != 0);
+                            else
+                                detail::appendArgument(buffer, byte);
+                            break;
+                        }
+                        case 'i':
+                            if (!reader.readVarint(value))
+                                return false;
+                            detail::appendArgument(buffer, static_cast<int64_t>((value >> 1) ^ (~(value & 1) + 1)));
+                            break;
+                        case 'u':
+                            if (!reader.readVarint(value))
+                                return false;
+                            detail::appendArgument(buffer, value);
+                            break;
+                        case 'f': {
+                            float floatValue;
+                            if (!reader.readFixed(value, 4))
+                                return false;
+                            const uint32_t bits = static_cast<uint32_t>(value);
+                            std::memcpy(&floatValue, &bits, sizeof(floatValue));
+                            detail::appendArgument(buffer, floatValue);
+                            break;
+                        }
+                        case 'd': {
+                            double doubleValue;
+                            if (!reader.readFixed(value, 8))
+                                return false;
+                            std::memcpy(&doubleValue, &value, sizeof(doubleValue));
+                            detail::appendArgument(buffer, doubleValue);
+                            break;
+                        }
+                        case 's':
+                            if (!reader.readString(text))
+                                return false;
+                            buffer.append(text);
+                            break;
+                        case 'r':
+                            if (!reader.readVarint(value))
+                                return false;
+                            buffer.append(strings[value]);
+                            break;
+                        default:
+                            return false;
+                    }
+                }
+
+                buffer.append('\n');
+                output.write(buffer.data(), static_cast<std::streamsize>(buffer.view().size()));
+            }
+            else
+                return false;
+        }
+
+        return true;
+    }
+
+} // namespace tl
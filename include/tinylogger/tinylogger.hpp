@@ -69,14 +69,126 @@
 #   define LOG_LINE_NUMBER 0
 #endif
 
+#ifndef    TINYLOGGER_COMPILED
+	// Set to 1 by the tinylogger library, which compiles the backend of the logger once
+#   define TINYLOGGER_COMPILED 0
+#endif
+
+#if (TINYLOGGER_COMPILED)
+    // Defined by the source file of the library, see TINYLOGGER_IMPLEMENTATION
+#   define TINYLOGGER_BACKEND
+#else
+#   define TINYLOGGER_BACKEND inline
+#endif
+
+#ifndef    TINYLOGGER_PAYLOAD_SIZE
+	// Bytes available in an asynchronous record to store the raw arguments
+#   define TINYLOGGER_PAYLOAD_SIZE 256
+#endif
+
+#ifndef    TINYLOGGER_FORMAT_BUFFER_SIZE
+	// Bytes of the per-thread buffer lines are formatted in before the heap
+#   define TINYLOGGER_FORMAT_BUFFER_SIZE 2048
+#endif
 
+#ifndef    TINYLOGGER_USE_TSC
+	// Can be set to 0 to timestamp the records with steady_clock instead of TSC
+#   if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#       define TINYLOGGER_USE_TSC 1
+#   else
+#       define TINYLOGGER_USE_TSC 0
+#   endif
+#endif
+
+
+#include <algorithm>
+#include <array>
 #include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <charconv>
+#include <cmath>
 #include <chrono>
+#include <climits>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <csignal>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <exception>
 #include <filesystem>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <memory>
 #include <mutex>
+#include <new>
+#include <optional>
 #include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32 // Low-level file and mapping API used by the file sinks
+#   include <fcntl.h>
+#   include <io.h>
+#   include <sys/stat.h>
+#   ifndef NOMINMAX
+#       define NOMINMAX
+#       define TINYLOGGER_DEFINED_NOMINMAX
+#   endif
+#   ifndef WIN32_LEAN_AND_MEAN
+#       define WIN32_LEAN_AND_MEAN
+#       define TINYLOGGER_DEFINED_WIN32_LEAN_AND_MEAN
+#   endif
+#   include <windows.h>
+#   ifdef TINYLOGGER_DEFINED_NOMINMAX
+#       undef NOMINMAX
+#       undef TINYLOGGER_DEFINED_NOMINMAX
+#   endif
+#   ifdef TINYLOGGER_DEFINED_WIN32_LEAN_AND_MEAN
+#       undef WIN32_LEAN_AND_MEAN
+#       undef TINYLOGGER_DEFINED_WIN32_LEAN_AND_MEAN
+#   endif
+#else
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <unistd.h>
+#   ifdef __linux__
+#       include <poll.h>
+#       include <sys/inotify.h>
+#       include <sys/syscall.h>
+#   endif
+#endif
+
+#ifndef    TINYLOGGER_USE_SSE2
+	// Can be set to 0 to escape the structured values without SSE2 instructions
+#   if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#       define TINYLOGGER_USE_SSE2 1
+#   else
+#       define TINYLOGGER_USE_SSE2 0
+#   endif
+#endif
+
+#if TINYLOGGER_USE_SSE2 // Vector scan of the strings escaped by StructuredWriter
+#   include <emmintrin.h>
+#endif
+
+#if TINYLOGGER_USE_TSC // Time stamp counter read by TickClock
+#   ifdef _MSC_VER
+#       include <intrin.h>
+#   else
+#       include <x86intrin.h>
+#   endif
+#endif
 
 
 enum class LogLevel {
@@ -90,257 +202,6496 @@ enum class LogLevel {
     TRACE    = 7
 };
 
-struct Logger {
-public:
+/*
+ * @brief Behaviour of the asynchronous mode when the record queue is full.
+ *
+ *  - BLOCK      : the producer waits until the backend frees a slot
+ *  - DROP_NEWEST: the record being logged is discarded
+ *  - DROP_OLDEST: the oldest queued record is discarded to make room
+ */
+enum class OverflowPolicy {
+    BLOCK       = 0,
+    DROP_NEWEST = 1,
+    DROP_OLDEST = 2
+};
+
+/*
+ * @brief What producers do when every slab of the record arena is in use,
+ *        see AsyncOptions::arenaCapacity.
+ *
+ *  - HEAP : the record is stored on the heap, as without arena
+ *  - BLOCK: the producer waits until the backend recycles a slab
+ *  - DROP : the record being logged is discarded
+ */
+enum class ArenaPolicy {
+    HEAP  = 0,
+    BLOCK = 1,
+    DROP  = 2
+};
+
+/*
+ * @brief Options of the asynchronous mode, see Logger::startAsync.
+ *
+ * @param queueCapacity       Number of records the queue can hold. It is
+ *                            rounded up to the next power of two.
+ * @param overflowPolicy      What producers do when the queue is full.
+ * @param backendSleep        Time the backend thread sleeps when queue is empty.
+ * @param threadQueues        Gives every thread logging its own queue, of
+ *                            threadQueueCapacity records, created on its first
+ *                            record and released when it exits. The backend
+ *                            merges the queues by timestamp. DROP_OLDEST then
+ *                            behaves as DROP_NEWEST, as only the backend reads
+ *                            the queue of a thread.
+ * @param threadQueueCapacity Number of records of the queue of every thread.
+ * @param numaShards          With threadQueues, number of backend threads,
+ *                            the queue of a thread first logging on the NUMA
+ *                            node n being drained by the backend n % numaShards.
+ *                            Backends format their records in parallel, but
+ *                            write them to the sinks one batch at a time, and
+ *                            records of different backends are not ordered.
+ * @param arenaCapacity       Bytes of the arena storing the arguments too large
+ *                            for the payload of a record, and the messages the
+ *                            producers format, instead of the heap. 0 disables
+ *                            the arena. Every thread logging holds a slab, so
+ *                            it should have a few slabs per thread.
+ * @param arenaSlabSize       Bytes a thread takes from the arena at once, a
+ *                            larger record being stored on the heap.
+ * @param arenaPolicy         What producers do when no slab is free.
+ */
+struct AsyncOptions {
+    size_t                    queueCapacity       = 8192;
+    OverflowPolicy            overflowPolicy      = OverflowPolicy::BLOCK;
+    std::chrono::microseconds backendSleep        = std::chrono::microseconds(100);
+    bool                      threadQueues        = false;
+    size_t                    threadQueueCapacity = 1024;
+    size_t                    numaShards          = 1;
+    size_t                    arenaCapacity       = 0;
+    size_t                    arenaSlabSize       = 64 * 1024;
+    ArenaPolicy               arenaPolicy         = ArenaPolicy::HEAP;
+};
+
+/*
+ * @brief Layout of the timestamp printed at the beginning of every message.
+ *
+ *  - CTIME  : 'Wed Oct 14 08:10:33 2026', same layout as std::ctime
+ *  - ISO8601: '2026-10-14T08:10:33+0200', local time with its UTC offset
+ *
+ * With a sub-second precision, digits are inserted right after the seconds.
+ */
+enum class TimestampFormat {
+    CTIME   = 0,
+    ISO8601 = 1
+};
+
+// Number of sub-second digits printed after the seconds of the timestamp
+enum class TimestampPrecision {
+    SECONDS      = 0,
+    MILLISECONDS = 3,
+    MICROSECONDS = 6
+};
+
+/*
+ * @brief Previous record the elapsed time printed after the timestamp is
+ *        measured from, zero being printed for the first one.
+ *
+ *  - THREAD  : previous record logged by the same thread
+ *  - CATEGORY: previous record of the same category, the records without
+ *              category sharing the one of the logger
+ */
+enum class ElapsedScope {
+    THREAD   = 0,
+    CATEGORY = 1
+};
+
+/*
+ * @brief Layout of the records logged with the LOG_<LEVEL>_KV macros.
+ *
+ *  - TEXT  : same line as the other records, the fields following the
+ *            message as 'key=value'
+ *  - JSON  : one object per line, as '{"time":"...","level":"INFO",...}'
+ *  - LOGFMT: 'time=... level=INFO ... message="request done" key=value'
+ *
+ * Structured layouts have their timestamp in UTC, as ISO 8601.
+ */
+enum class StructuredFormat {
+    TEXT   = 0,
+    JSON   = 1,
+    LOGFMT = 2
+};
+
+
+struct Logger;
+
+namespace tl {
+namespace detail {
+
+    // Size used to keep frequently written atomics on separate cache lines
+    inline constexpr size_t cacheLineSize = 64;
+
     /*
-	 * @brief Constructs a Logger instance, with the specified log level.
-     * 
-	 * @param logLevel The initial log level for the logger. See LogLevel
-	 *                 enum class for available log levels.
-     * 
-	 * @note /!\ Caution: This constructor will be called only once, when
-     *           all the header is included in the code, thanks to inline
-     *           Logger instance, declared at the end of this struct. 
-	 *           The user, once that the header is included does not have
-                 to declare another instance, and can directly use macros
+     * @brief Bounded lock-free multi-producer multi-consumer queue.
+     *
+     * Every cell carries a sequence number telling whether it is ready to be
+     * written or read for a given lap (D. Vyukov's bounded queue). Producers
+     * and consumers only contend on their own position counter. The consumer
+     * side is multi-threaded only so that producers can evict the oldest
+     * record when the DROP_OLDEST policy is selected.
      */
-    Logger(LogLevel logLevel) : logLevel_(logLevel) {
-		// Initialize the current time and last log time
-        lastLogTime_ = std::chrono::system_clock::now();
+    template <typename T>
+    class BoundedQueue {
+    public:
+        explicit BoundedQueue(size_t capacity) {
+            size_t roundedCapacity = 2;
+            while (roundedCapacity < capacity)
+                roundedCapacity <<= 1;
+
+            mask_  = roundedCapacity - 1;
+            cells_ = std::make_unique<Cell[]>(roundedCapacity);
+            for (size_t i = 0; i < roundedCapacity; ++i)
+                cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        bool tryPush(T&& value) {
+            size_t position = enqueuePosition_.load(std::memory_order_relaxed);
+            for (;;) {
+                Cell&     cell       = cells_[position & mask_];
+                size_t    sequence   = cell.sequence.load(std::memory_order_acquire);
+                ptrdiff_t difference = static_cast<ptrdiff_t>(sequence) - static_cast<ptrdiff_t>(position);
+
+                if (difference == 0) {
+                    if (enqueuePosition_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                        cell.data = std::move(value);
+                        cell.sequence.store(position + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (difference < 0)
+                    return false; // Queue is full
+                else
+                    position = enqueuePosition_.load(std::memory_order_relaxed);
+            }
+        }
+
+        bool tryPop(T& value) {
+            return tryVisit([&value](T& data) { value = std::move(data); });
+        }
+
+        /*
+         * Pops the next value by calling function on it in its cell, where it
+         * stays until a push replaces it. Used as is by the crash handler,
+         * which must not free the memory owned by the value.
+         */
+        template <typename Function>
+        bool tryVisit(Function&& function) {
+            size_t position = dequeuePosition_.load(std::memory_order_relaxed);
+            for (;;) {
+                Cell&     cell       = cells_[position & mask_];
+                size_t    sequence   = cell.sequence.load(std::memory_order_acquire);
+                ptrdiff_t difference = static_cast<ptrdiff_t>(sequence) - static_cast<ptrdiff_t>(position + 1);
+
+                if (difference == 0) {
+                    if (dequeuePosition_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                        function(cell.data);
+                        cell.sequence.store(position + mask_ + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (difference < 0)
+                    return false; // Queue is empty
+                else
+                    position = dequeuePosition_.load(std::memory_order_relaxed);
+            }
+        }
+
+        size_t capacity() const { return mask_ + 1; }
+
+    private:
+        struct Cell {
+            std::atomic<size_t> sequence{ 0 };
+            T                   data;
+        };
+
+        std::unique_ptr<Cell[]> cells_;
+        size_t                  mask_ = 0;
+
+        alignas(cacheLineSize) std::atomic<size_t> enqueuePosition_{ 0 };
+        alignas(cacheLineSize) std::atomic<size_t> dequeuePosition_{ 0 };
+    };
+
+    /*
+     * @brief Bounded single-producer single-consumer ring.
+     *
+     * Positions only grow, the slot being the position modulo the capacity.
+     * Each side keeps a copy of the position of the other one, and only
+     * reloads it when the ring looks full or empty, so that the cache line
+     * of the other side is rarely read.
+     */
+    template <typename T>
+    class SpscQueue {
+    public:
+        explicit SpscQueue(size_t capacity) {
+            size_t roundedCapacity = 2;
+            while (roundedCapacity < capacity)
+                roundedCapacity <<= 1;
+
+            mask_  = roundedCapacity - 1;
+            slots_ = std::make_unique<T[]>(roundedCapacity);
+        }
+
+        // Called by the producer only
+        bool tryPush(T&& value) {
+            const size_t position = pushPosition_.load(std::memory_order_relaxed);
+            if (position - cachedPopPosition_ > mask_) {
+                cachedPopPosition_ = popPosition_.load(std::memory_order_acquire);
+                if (position - cachedPopPosition_ > mask_)
+                    return false; // Queue is full
+            }
+
+            slots_[position & mask_] = std::move(value);
+            pushPosition_.store(position + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Called by the consumer only, returns nullptr if the queue is empty
+        T* front() {
+            const size_t position = popPosition_.load(std::memory_order_relaxed);
+            if (position == cachedPushPosition_) {
+                cachedPushPosition_ = pushPosition_.load(std::memory_order_acquire);
+                if (position == cachedPushPosition_)
+                    return nullptr;
+            }
+            return &slots_[position & mask_];
+        }
+
+        // Called by the consumer only, after front returned a value
+        void pop() {
+            popPosition_.store(popPosition_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        // Number of values pushed and popped since construction
+        size_t pushed() const { return pushPosition_.load(std::memory_order_acquire); }
+        size_t popped() const { return popPosition_.load(std::memory_order_acquire); }
+
+        size_t capacity() const { return mask_ + 1; }
+
+    private:
+        std::unique_ptr<T[]> slots_;
+        size_t               mask_ = 0;
+
+        alignas(cacheLineSize) std::atomic<size_t> pushPosition_{ 0 };
+        size_t                                     cachedPopPosition_  = 0;
+        alignas(cacheLineSize) std::atomic<size_t> popPosition_{ 0 };
+        size_t                                     cachedPushPosition_ = 0;
+    };
+
+    // Anonymous memory, backed by transparent huge pages where available
+    inline char* allocatePages(size_t size) {
+#ifdef _WIN32
+        return static_cast<char*>(VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE));
+#else
+        void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (memory == MAP_FAILED)
+            return nullptr;
+#   ifdef MADV_HUGEPAGE
+        madvise(memory, size, MADV_HUGEPAGE);
+#   endif
+        return static_cast<char*>(memory);
+#endif
+    }
 
-        currentTimeInstanced_ = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
-        #ifdef _WIN32 // ctime_s is used for Windows compatibility
-            ctime_s(currentTimeChar_, sizeof(currentTimeChar_), &currentTimeInstanced_); currentTimeChar_[24] = '\0';
-        #else         // ctime_r is used for Linux compatibility
-            ctime_r(&currentTimeInstanced_, currentTimeChar_); currentTimeChar_[24] = '\0';
-        #endif        // Both are thread-safe while using ctime only is not
+    inline void freePages(char* memory, size_t size) {
+#ifdef _WIN32
+        (void)size;
+        VirtualFree(memory, 0, MEM_RELEASE);
+#else
+        munmap(memory, size);
+#endif
     }
 
     /*
-	 * @brief Concatenates arguments, and logs at the specified level.
-     * 
-	 * This function will be the main entry point for some macros when
-	 * maximum log level is defined at compilation time. For the other
-	 * case, the macros will call the specific log functions directly.
+     * @brief Part of a RecordArena, allocated by a single thread at a time.
      *
-	 * @tparam Args (variadic): Any arguments, of any streamable type.
-     * 
-	 * @param logLevel Log level at which the message should be logged
-	 * @param args    (variadic): Any arguments of any streamable type
-     * 
-     * @note It is strongly recommended to use the macros, rather than
-	 *       this function directly. The macros will optimise the code
-	 *       performance and may reduce the binary size.
+     * outstanding is decremented by the backend for every record written,
+     * and incremented by the number of records allocated when the producer
+     * retires the slab. The side bringing it back to zero recycles the slab,
+     * which cannot happen before the retirement.
      */
-    template <typename... Args>
-    INLINING_TINYLOGGER void log(LogLevel logLevel, Args&&... args) const {
-        if (logLevel <= logLevel_) {
-            switch (logLevel) {
-                case LogLevel::TRACE:
-				    logTRACE(args...);    break;
-                case LogLevel::DEBUG:
-                    logDEBUG(args...);    break;
-                case LogLevel::VERBOSE:
-                    logVERBOSE(args...);  break;
-                case LogLevel::INFO:
-                    logINFO(args...);     break;
-                case LogLevel::WARNING:
-                    logWARNING(args...);  break;
-                case LogLevel::LERROR:
-                    logERROR(args...);    break;
-                case LogLevel::CRITICAL:
-                    logCRITICAL(args...); break;
-                default:
-                    break;
+    struct ArenaSlab {
+        char*                data = nullptr;
+        std::atomic<int64_t> outstanding{ 0 };
+    };
+
+    /*
+     * @brief Memory of the records too large for their payload, see
+     *        AsyncOptions::arenaCapacity. Slabs are taken by the producers,
+     *        bump-allocated by an ArenaCursor, and recycled whole once every
+     *        record of a retired slab is written, so that nothing is allocated
+     *        or freed after construction.
+     */
+    class RecordArena {
+    public:
+        RecordArena(size_t capacity, size_t slabSize) : slabSize_(std::max<size_t>(slabSize, 4096)) {
+            size_t slabCount = std::max<size_t>(capacity / slabSize_, 1);
+            size_            = slabCount * slabSize_;
+            memory_          = allocatePages(size_);
+            if (!memory_)
+                slabCount = 0;
+
+            slabs_ = std::make_unique<ArenaSlab[]>(slabCount);
+            free_.reserve(slabCount);
+            for (size_t i = slabCount; i-- > 0; ) {
+                slabs_[i].data = memory_ + i * slabSize_;
+                free_.push_back(&slabs_[i]);
+            }
+            slabCount_ = slabCount;
+        }
+
+        RecordArena(const RecordArena&)            = delete;
+        RecordArena& operator=(const RecordArena&) = delete;
+
+        ~RecordArena() {
+            if (memory_)
+                freePages(memory_, size_);
+        }
+
+        // Returns a free slab, or nullptr if every slab is in use
+        ArenaSlab* acquire() {
+            std::lock_guard<std::mutex> guard(mutex_);
+            if (free_.empty())
+                return nullptr;
+            ArenaSlab* slab = free_.back();
+            free_.pop_back();
+            return slab;
+        }
+
+        // Called by the producer when it stops allocating from the slab
+        void retire(ArenaSlab* slab, int64_t allocations) {
+            if (slab->outstanding.fetch_add(allocations, std::memory_order_acq_rel) == -allocations)
+                recycle(slab);
+        }
+
+        // Called by the backend when a record allocated in the slab is written
+        void release(ArenaSlab* slab) {
+            if (slab->outstanding.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                recycle(slab);
+        }
+
+        size_t slabSize()  const { return slabSize_; }
+        size_t slabCount() const { return slabCount_; }
+
+    private:
+        void recycle(ArenaSlab* slab) {
+            // Never allocates, as free_ has room for every slab
+            std::lock_guard<std::mutex> guard(mutex_);
+            free_.push_back(slab);
+        }
+
+        size_t                       slabSize_;
+        size_t                       slabCount_ = 0;
+        size_t                       size_      = 0;
+        char*                        memory_    = nullptr;
+        std::unique_ptr<ArenaSlab[]> slabs_;
+        std::vector<ArenaSlab*>      free_;
+        std::mutex                   mutex_;
+    };
+
+    // Slab a producer thread bump-allocates from, retired when the thread exits
+    class ArenaCursor {
+    public:
+        ArenaCursor() = default;
+        explicit ArenaCursor(RecordArena* arena) : arena_(arena) {}
+
+        ArenaCursor(ArenaCursor&& other) noexcept { *this = std::move(other); }
+
+        ArenaCursor& operator=(ArenaCursor&& other) noexcept {
+            if (this != &other) {
+                retire();
+                arena_       = std::exchange(other.arena_, nullptr);
+                slab_        = std::exchange(other.slab_, nullptr);
+                used_        = std::exchange(other.used_, 0);
+                allocations_ = std::exchange(other.allocations_, 0);
+            }
+            return *this;
+        }
+
+        ~ArenaCursor() { retire(); }
+
+        // Free bytes of the slab, both nullptr without slab
+        char*       begin() const { return slab_ ? slab_->data + used_ : nullptr; }
+        const char* end()   const { return slab_ ? slab_->data + arena_->slabSize() : nullptr; }
+
+        // Allocates the bytes from begin to end, returns the slab to release them to
+        ArenaSlab* commit(const char* end) {
+            used_ = static_cast<size_t>(end - slab_->data);
+            ++allocations_;
+            return slab_;
+        }
+
+        // Retires the slab for a free one, returns false if every slab is in use
+        bool renew() {
+            retire();
+            slab_ = arena_ ? arena_->acquire() : nullptr;
+            return slab_ != nullptr;
+        }
+
+    private:
+        void retire() {
+            if (slab_)
+                arena_->retire(slab_, allocations_);
+            slab_        = nullptr;
+            used_        = 0;
+            allocations_ = 0;
+        }
+
+        RecordArena* arena_       = nullptr;
+        ArenaSlab*   slab_        = nullptr;
+        size_t       used_        = 0;
+        int64_t      allocations_ = 0;
+    };
+
+
+    // Two ASCII digits for every value in [0, 99], used to render integers
+    inline constexpr char digitPairs[] =
+        "00010203040506070809101112131415161718192021222324252627282930313233343536373839404142434445464748495051525354555657585960616263646566676869707172737475767778798081828384858687888990919293949596979899";
+
+    // Writes value on exactly width digits padded with zeros, returns the end
+    inline char* writeFixedDigits(char* destination, uint64_t value, int width) {
+        char* cursor = destination + width;
+        for (; cursor - destination >= 2; value /= 100) {
+            const size_t pair = static_cast<size_t>(value % 100) * 2;
+            *--cursor = digitPairs[pair + 1];
+            *--cursor = digitPairs[pair];
+        }
+        if (cursor != destination)
+            *--cursor = static_cast<char>('0' + value % 10);
+        return destination + width;
+    }
+
+    // Writes value without padding, returns the end of the written digits
+    inline char* writeUnsigned(char* destination, uint64_t value) {
+        int width = 1;
+        for (uint64_t remaining = value; remaining >= 10; remaining /= 10)
+            ++width;
+        return writeFixedDigits(destination, value, width);
+    }
+
+    /*
+     * @brief Renders timestamps, re-rendering the date and the time only when
+     *        the second changes. Sub-second digits are patched in place.
+     *
+     * @note Not thread-safe, every instance must be used by a single thread
+     *       at once.
+     */
+    class TimestampCache {
+    public:
+        std::string_view render(std::chrono::system_clock::time_point time,
+                                TimestampFormat format, TimestampPrecision precision) {
+            const int64_t microseconds = std::chrono::duration_cast<std::chrono::microseconds>(time.time_since_epoch()).count();
+
+            // Flooring division, so that dates before epoch stay consistent
+            int64_t seconds  = microseconds / 1000000;
+            int64_t fraction = microseconds % 1000000;
+            if (fraction < 0) {
+                fraction += 1000000;
+                seconds  -= 1;
+            }
+
+            const int digits = static_cast<int>(precision);
+            if (length_ == 0 || seconds != cachedSecond_ || format != cachedFormat_ || digits != cachedDigits_)
+                renderSecond(seconds, format, digits);
+
+            if (digits > 0) {
+                static const int64_t divisors[] = { 1000000, 100000, 10000, 1000, 100, 10, 1 };
+                writeFixedDigits(buffer_ + fractionOffset + 1, static_cast<uint64_t>(fraction / divisors[digits]), digits);
+            }
+
+            return std::string_view(buffer_, length_);
+        }
+
+    private:
+        // Both layouts have 19 characters before the sub-second digits
+        static constexpr size_t fractionOffset = 19;
+
+        void renderSecond(int64_t seconds, TimestampFormat format, int digits) {
+            static const char dayNames[]   = "SunMonTueWedThuFriSat";
+            static const char monthNames[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+
+            const time_t instant = static_cast<time_t>(seconds);
+            std::tm      local{};
+            #ifdef _WIN32 // localtime_s is used for Windows compatibility
+                localtime_s(&local, &instant);
+            #else         // localtime_r is used for Linux compatibility
+                localtime_r(&instant, &local);
+            #endif        // Both are thread-safe while using localtime only is not
+
+            char* cursor = buffer_;
+            if (format == TimestampFormat::CTIME) {
+                cursor    = std::copy_n(dayNames   + 3 * local.tm_wday, 3, cursor);
+                *cursor++ = ' ';
+                cursor    = std::copy_n(monthNames + 3 * local.tm_mon,  3, cursor);
+                *cursor++ = ' ';
+                *cursor++ = local.tm_mday < 10 ? ' ' : static_cast<char>('0' + local.tm_mday / 10);
+                *cursor++ = static_cast<char>('0' + local.tm_mday % 10);
+                *cursor++ = ' ';
+            }
+            else {
+                cursor    = writeFixedDigits(cursor, static_cast<uint64_t>(local.tm_year + 1900), 4);
+                *cursor++ = '-';
+                cursor    = writeFixedDigits(cursor, static_cast<uint64_t>(local.tm_mon + 1), 2);
+                *cursor++ = '-';
+                cursor    = writeFixedDigits(cursor, static_cast<uint64_t>(local.tm_mday), 2);
+                *cursor++ = 'T';
+            }
+
+            cursor    = writeFixedDigits(cursor, static_cast<uint64_t>(local.tm_hour), 2);
+            *cursor++ = ':';
+            cursor    = writeFixedDigits(cursor, static_cast<uint64_t>(local.tm_min),  2);
+            *cursor++ = ':';
+            cursor    = writeFixedDigits(cursor, static_cast<uint64_t>(local.tm_sec),  2);
+
+            if (digits > 0) {
+                *cursor = '.';
+                cursor += digits + 1; // Placeholder for the sub-second digits
+            }
+
+            if (format == TimestampFormat::CTIME) {
+                *cursor++ = ' ';
+                cursor    = writeUnsigned(cursor, static_cast<uint64_t>(local.tm_year + 1900));
+            }
+            else
+                cursor += std::strftime(cursor, sizeof(buffer_) - static_cast<size_t>(cursor - buffer_), "%z", &local);
+
+            length_       = static_cast<size_t>(cursor - buffer_);
+            cachedSecond_ = seconds;
+            cachedFormat_ = format;
+            cachedDigits_ = digits;
+        }
+
+        int64_t         cachedSecond_ = 0;
+        TimestampFormat cachedFormat_ = TimestampFormat::CTIME;
+        int             cachedDigits_ = 0;
+        char            buffer_[48];
+        size_t          length_       = 0;
+    };
+
+    // Writes ' +S.fff s ', with at least a millisecond precision
+    inline char* writeElapsed(char* cursor, int64_t elapsedMicroseconds, TimestampPrecision precision) {
+        const int      digits  = std::max(static_cast<int>(precision), 3);
+        const uint64_t elapsed = static_cast<uint64_t>(std::max<int64_t>(elapsedMicroseconds, 0));
+
+        cursor    = std::copy_n(" +", 2, cursor);
+        cursor    = writeUnsigned(cursor, elapsed / 1000000);
+        *cursor++ = '.';
+        cursor    = writeFixedDigits(cursor, (elapsed % 1000000) / (digits == 3 ? 1000 : 1), digits);
+        return std::copy_n(" s ", 3, cursor);
+    }
+
+    /*
+     * @brief Writes time as '2026-10-14T08:10:33.123Z', in UTC since the time
+     *        zone of localtime_r may take a lock. Used by the crash handler.
+     */
+    inline char* writeUtcTimestamp(char* cursor, std::chrono::system_clock::time_point time, TimestampPrecision precision) {
+        const int64_t microseconds = std::chrono::duration_cast<std::chrono::microseconds>(time.time_since_epoch()).count();
+        const int64_t seconds      = microseconds / 1000000 - (microseconds % 1000000 < 0);
+        const int64_t daySeconds   = seconds - (seconds / 86400 - (seconds % 86400 < 0)) * 86400;
+
+        // Civil date of the day since epoch, from H. Hinnant's algorithm
+        const int64_t days      = (seconds - daySeconds) / 86400 + 719468;
+        const int64_t era       = (days >= 0 ? days : days - 146096) / 146097;
+        const int64_t dayOfEra  = days - era * 146097;
+        const int64_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+        const int64_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+        const int64_t monthFromMarch = (5 * dayOfYear + 2) / 153;
+        const int64_t day       = dayOfYear - (153 * monthFromMarch + 2) / 5 + 1;
+        const int64_t month     = monthFromMarch < 10 ? monthFromMarch + 3 : monthFromMarch - 9;
+        const int64_t year      = yearOfEra + era * 400 + (month <= 2);
+
+        cursor    = writeFixedDigits(cursor, static_cast<uint64_t>(year), 4);
+        *cursor++ = '-';
+        cursor    = writeFixedDigits(cursor, static_cast<uint64_t>(month), 2);
+        *cursor++ = '-';
+        cursor    = writeFixedDigits(cursor, static_cast<uint64_t>(day), 2);
+        *cursor++ = 'T';
+        cursor    = writeFixedDigits(cursor, static_cast<uint64_t>(daySeconds / 3600), 2);
+        *cursor++ = ':';
+        cursor    = writeFixedDigits(cursor, static_cast<uint64_t>(daySeconds / 60 % 60), 2);
+        *cursor++ = ':';
+        cursor    = writeFixedDigits(cursor, static_cast<uint64_t>(daySeconds % 60), 2);
+
+        const int digits = static_cast<int>(precision);
+        if (digits > 0) {
+            static const int64_t divisors[] = { 1000000, 100000, 10000, 1000, 100, 10, 1 };
+            *cursor++ = '.';
+            cursor    = writeFixedDigits(cursor, static_cast<uint64_t>((microseconds - seconds * 1000000) / divisors[digits]), digits);
+        }
+        *cursor++ = 'Z';
+        return cursor;
+    }
+
+    // Writes all the data to the descriptor, only with write(2), so also from a signal handler
+    inline void writeDescriptor(int descriptor, const char* data, size_t size) {
+        if (descriptor < 0)
+            return;
+
+        while (size > 0) {
+            #ifdef _WIN32
+                const int written = _write(descriptor, data, static_cast<unsigned int>(std::min<size_t>(size, INT_MAX)));
+            #else
+                const ssize_t written = ::write(descriptor, data, size);
+                if (written < 0 && errno == EINTR)
+                    continue;
+            #endif
+            if (written <= 0)
+                return; // Lines are lost rather than blocking the logger
+
+            data += written;
+            size -= static_cast<size_t>(written);
+        }
+    }
+
+    /*
+     * @brief Monotonic clock the records are timestamped with: the time stamp
+     *        counter of the processor if TINYLOGGER_USE_TSC, else steady_clock
+     *        in nanoseconds. Ticks are turned into wall-clock time by
+     *        ClockCalibration, and their differences into durations.
+     */
+    struct TickClock {
+        static uint64_t now() {
+#if TINYLOGGER_USE_TSC
+            return __rdtsc();
+#else
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+        }
+
+        // Measured once against steady_clock, which takes 2 ms with the counter
+        static double nanosecondsPerTick() {
+            static const double duration = measureTick();
+            return duration;
+        }
+
+        static int64_t toNanoseconds(int64_t ticks) {
+            return static_cast<int64_t>(static_cast<double>(ticks) * nanosecondsPerTick());
+        }
+
+    private:
+        static double measureTick() {
+#if TINYLOGGER_USE_TSC
+            using Clock = std::chrono::steady_clock;
+
+            const Clock::time_point start      = Clock::now();
+            const uint64_t          startTicks = now();
+            Clock::time_point       end        = start;
+            while (end - start < std::chrono::milliseconds(2))
+                end = Clock::now();
+            const uint64_t ticks = now() - startTicks;
+
+            const auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+            return ticks ? static_cast<double>(nanoseconds) / static_cast<double>(ticks) : 1.0;
+#else
+            return 1.0;
+#endif
+        }
+    };
+
+    /*
+     * @brief Converts ticks to wall-clock time, from a reading of both clocks
+     *        renewed every second, so that adjustments of the system clock are
+     *        followed without the records reading it. Not thread-safe: every
+     *        thread converting ticks uses its own, see threadClockCalibration.
+     */
+    class ClockCalibration {
+    public:
+        std::chrono::system_clock::time_point toSystemTime(uint64_t ticks) {
+            if (static_cast<int64_t>(ticks - baseTicks_) > refreshTicks_)
+                calibrate();
+
+            const int64_t nanoseconds = baseTime_ + TickClock::toNanoseconds(static_cast<int64_t>(ticks - baseTicks_));
+            return std::chrono::system_clock::time_point(
+                std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(nanoseconds)));
+        }
+
+    private:
+        void calibrate() {
+            baseTicks_    = TickClock::now();
+            baseTime_     = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+            refreshTicks_ = static_cast<int64_t>(1e9 / TickClock::nanosecondsPerTick());
+        }
+
+        uint64_t baseTicks_    = 0;
+        int64_t  baseTime_     = 0;
+        int64_t  refreshTicks_ = -1;
+    };
+
+    inline const char* levelLabel(LogLevel logLevel) {
+        switch (logLevel) {
+            case LogLevel::TRACE:    return "[TRACE]    ";
+            case LogLevel::DEBUG:    return "[DEBUG]    ";
+            case LogLevel::VERBOSE:  return "[VERBOSE]  ";
+            case LogLevel::INFO:     return "[INFO]     ";
+            case LogLevel::WARNING:  return "[WARNING]  ";
+            case LogLevel::LERROR:   return "[ERROR]    ";
+            case LogLevel::CRITICAL: return "[CRITICAL] ";
+            default:                 return "";
+        }
+    }
+
+    // Level of the structured records, see StructuredFormat
+    inline const char* levelName(LogLevel logLevel) {
+        switch (logLevel) {
+            case LogLevel::TRACE:    return "TRACE";
+            case LogLevel::DEBUG:    return "DEBUG";
+            case LogLevel::VERBOSE:  return "VERBOSE";
+            case LogLevel::INFO:     return "INFO";
+            case LogLevel::WARNING:  return "WARNING";
+            case LogLevel::LERROR:   return "ERROR";
+            case LogLevel::CRITICAL: return "CRITICAL";
+            default:                 return "OFF";
+        }
+    }
+
+    inline std::atomic<uint32_t> callSiteCount{ 0 };
+
+    // Bumped by every log level change, to invalidate the call site caches
+    inline std::atomic<uint32_t> levelGeneration{ 1 };
+
+} // namespace detail
+
+
+    /*
+     * @brief Static description of a logging statement. Every expansion of a
+     *        LOG_* macro owns one, created on its first execution, whose id is
+     *        unique in the process. Binary sinks write the description once,
+     *        and then only refer to it by its id.
+     *
+     *        It also caches whether it is enabled, with the level generation
+     *        the answer was computed for: (generation << 1) | enabled. When
+     *        the call site belongs to a category, its level is the one used.
+     */
+    class Category;
+
+    struct CallSite {
+        explicit CallSite(LogLevel siteLogLevel, const Category* siteCategory = nullptr)
+            : logLevel(siteLogLevel), category(siteCategory),
+              id(detail::callSiteCount.fetch_add(1, std::memory_order_relaxed) + 1) {}
+
+        const LogLevel        logLevel;
+        const Category* const category;
+        const uint32_t        id;
+
+        mutable std::atomic<uint32_t> cachedState{ 0 };
+    };
+
+namespace detail {
+
+    // Call sites of the logging functions, when used without the macros
+    inline const CallSite& levelCallSite(LogLevel logLevel) {
+        static const CallSite callSites[] = {
+            CallSite(LogLevel::OFF),  CallSite(LogLevel::CRITICAL), CallSite(LogLevel::LERROR), CallSite(LogLevel::WARNING),
+            CallSite(LogLevel::INFO), CallSite(LogLevel::VERBOSE),  CallSite(LogLevel::DEBUG),  CallSite(LogLevel::TRACE)
+        };
+        return callSites[static_cast<int>(logLevel)];
+    }
+
+} // namespace detail
+
+
+    /*
+     * @brief Reference to a string with static storage duration, such as the
+     *        literals and __FUNCTION__ used by LOG_CONTEXT(). Only the pointer
+     *        is copied when the record is deferred to the backend thread.
+     */
+    struct StaticString {
+        template <size_t N>
+        constexpr StaticString(const char (&string)[N]) : data(string), size(N - 1) {}
+
+        constexpr StaticString(const char* string, size_t stringSize) : data(string), size(stringSize) {}
+
+        const char* data;
+        size_t      size;
+    };
+
+    inline std::ostream& operator<<(std::ostream& stream, const StaticString& string) {
+        return stream.write(string.data, static_cast<std::streamsize>(string.size));
+    }
+
+namespace detail {
+
+    // Characters of a context prefix built at compile time, see joinContext
+    template <size_t N>
+    struct ContextString {
+        char   data[N] = {};
+        size_t size    = 0;
+    };
+
+    /*
+     * @brief Joins the pieces of a context prefix during the compilation, as
+     *        in ": in [" "main.cpp" "] ", keeping only the base name of file.
+     */
+    template <size_t H, size_t F, size_t T>
+    constexpr ContextString<H + F + T> joinContext(const char (&head)[H], const char (&file)[F], const char (&tail)[T]) {
+        ContextString<H + F + T> context;
+
+        size_t baseName = 0;
+        for (size_t i = 0; i + 1 < F; ++i)
+            if (file[i] == '/' || file[i] == '\\')
+                baseName = i + 1;
+
+        for (size_t i = 0; i + 1 < H; ++i)
+            context.data[context.size++] = head[i];
+        for (size_t i = baseName; i + 1 < F; ++i)
+            context.data[context.size++] = file[i];
+        for (size_t i = 0; i + 1 < T; ++i)
+            context.data[context.size++] = tail[i];
+        return context;
+    }
+
+    /*
+     * @brief Prepends the function name to the context known at compile time.
+     *        Site is a type unique to the macro expansion, so that the prefix
+     *        is built on its first execution only, and then referenced.
+     */
+    template <typename Site>
+    StaticString functionContext(Site, const char* function, StaticString context) {
+        static const std::string prefix = std::string(function) + std::string(context.data, context.size);
+        return StaticString(prefix.data(), prefix.size());
+    }
+
+} // namespace detail
+
+
+
+    /*
+     * =========================================================================
+     *                            Binary Log Format
+     * =========================================================================
+     *
+     * A binary log is a sequence of entries, each one starting with a tag:
+     *  - 'T' Session   : 'LOGBIN1', written when a sink opens the file. Every
+     *                    id defined before is forgotten.
+     *  - 'S' String    : varint id, varint size, characters of a static string
+     *  - 'C' Call site : varint id, byte level
+     *  - 'R' Record    : varint call site id, 8-byte timestamp (microseconds
+     *                    since epoch), varint argument count, arguments
+     *
+     * Arguments also start with a tag: 'b' bool and 'c' char (one byte), 'i'
+     * signed integer (zigzag varint), 'u' unsigned integer (varint), 'f' float
+     * and 'd' double (IEEE 754), 's' string (varint size, characters) or 'r'
+     * static string (varint id). Fixed-size values are little-endian.
+     */
+namespace binary {
+
+    inline constexpr char sessionTag[]  = "TLOGBIN1";
+    inline constexpr char stringTag     = 'S';
+    inline constexpr char callSiteTag   = 'C';
+    inline constexpr char recordTag     = 'R';
+
+    inline void writeVarint(std::string& output, uint64_t value) {
+        while (value >= 0x80) {
+            output.push_back(static_cast<char>((value & 0x7F) | 0x80));
+            value >>= 7;
+        }
+        output.push_back(static_cast<char>(value));
+    }
+
+    inline void writeFixed(std::string& output, uint64_t value, int size) {
+        for (int i = 0; i < size; ++i)
+            output.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+
+} // namespace binary
+
+    /*
+     * @brief Writes the arguments of a record in the binary log format. The
+     *        static strings met for the first time are defined in definitions,
+     *        and their id kept in strings, while the record goes to record.
+     */
+    class BinaryEncoder {
+    public:
+        BinaryEncoder(std::string& definitions, std::string& record, std::unordered_map<const char*, uint32_t>& strings)
+            : definitions_(definitions), record_(record), strings_(strings) {}
+
+        template <typename T>
+        void writeArithmetic(T value) {
+            if constexpr (std::is_same_v<T, bool>) {
+                record_.push_back('b');
+                record_.push_back(value ? 1 : 0);
+            }
+            else if constexpr (std::is_same_v<T, char> || std::is_same_v<T, signed char> || std::is_same_v<T, unsigned char>) {
+                record_.push_back('c');
+                record_.push_back(static_cast<char>(value));
+            }
+            else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+                const int64_t  signedValue = static_cast<int64_t>(value);
+                const uint64_t zigzag      = (static_cast<uint64_t>(signedValue) << 1) ^ static_cast<uint64_t>(signedValue >> 63);
+                record_.push_back('i');
+                binary::writeVarint(record_, zigzag);
+            }
+            else if constexpr (std::is_integral_v<T>) {
+                record_.push_back('u');
+                binary::writeVarint(record_, static_cast<uint64_t>(value));
+            }
+            else if constexpr (std::is_same_v<T, float>) {
+                uint32_t bits;
+                std::memcpy(&bits, &value, sizeof(bits));
+                record_.push_back('f');
+                binary::writeFixed(record_, bits, 4);
+            }
+            else {
+                const double doubleValue = static_cast<double>(value);
+                uint64_t     bits;
+                std::memcpy(&bits, &doubleValue, sizeof(bits));
+                record_.push_back('d');
+                binary::writeFixed(record_, bits, 8);
+            }
+        }
+
+        void writeString(std::string_view value) {
+            record_.push_back('s');
+            binary::writeVarint(record_, value.size());
+            record_.append(value.data(), value.size());
+        }
+
+        void writeStaticString(const char* data, size_t size) {
+            auto iterator = strings_.find(data);
+            if (iterator == strings_.end()) {
+                iterator = strings_.emplace(data, static_cast<uint32_t>(strings_.size() + 1)).first;
+                definitions_.push_back(binary::stringTag);
+                binary::writeVarint(definitions_, iterator->second);
+                binary::writeVarint(definitions_, size);
+                definitions_.append(data, size);
+            }
+            record_.push_back('r');
+            binary::writeVarint(record_, iterator->second);
+        }
+
+    private:
+        std::string&                               definitions_;
+        std::string&                               record_;
+        std::unordered_map<const char*, uint32_t>& strings_;
+    };
+
+namespace detail {
+
+    // Number of lines that did not fit in a FormatBuffer, for all threads
+    inline std::atomic<size_t> formatHeapFallbacks{ 0 };
+
+    /*
+     * @brief Character buffer in which a whole line is formatted. It writes
+     *        in a fixed-size inline array, and only moves to the heap when a
+     *        line exceeds TINYLOGGER_FORMAT_BUFFER_SIZE. The heap storage is
+     *        kept, so that a thread reallocates only for ever larger lines.
+     *
+     * Once bounded, for the crash handler, the buffer never allocates: the
+     * line is truncated to the inline array instead, see bound.
+     */
+    class FormatBuffer {
+    public:
+        void clear() {
+            size_    = 0;
+            storage_ = Storage::INLINE;
+        }
+
+        void append(char character) {
+            if (storage_ == Storage::INLINE && size_ < sizeof(inline_))
+                inline_[size_++] = character;
+            else
+                append(std::string_view(&character, 1));
+        }
+
+        void append(std::string_view string) {
+            if (spill_ && (storage_ == Storage::TRUNCATED || size_ + string.size() > sizeof(inline_))) {
+                // What still fits is kept, the rest of the line is dropped
+                const size_t size = storage_ == Storage::TRUNCATED ? 0 : std::min(string.size(), sizeof(inline_) - size_);
+                std::memcpy(inline_ + size_, string.data(), size);
+                size_   += size;
+                storage_ = Storage::TRUNCATED;
+                return;
+            }
+            std::memcpy(reserve(string.size()), string.data(), string.size());
+            size_ += string.size();
+        }
+
+        // Returns room for at least size characters, to be committed after
+        char* reserve(size_t size) {
+            if (storage_ == Storage::INLINE && size_ + size <= sizeof(inline_))
+                return inline_ + size_;
+
+            if (spill_) {
+                storage_ = Storage::TRUNCATED;
+                return spill_;
+            }
+            if (storage_ == Storage::INLINE) {
+                formatHeapFallbacks.fetch_add(1, std::memory_order_relaxed);
+                heap_.resize(std::max(heap_.size(), 2 * sizeof(inline_)));
+                std::memcpy(&heap_[0], inline_, size_);
+                storage_ = Storage::HEAP;
+            }
+            if (size_ + size > heap_.size())
+                heap_.resize(std::max(2 * heap_.size(), size_ + size));
+            return &heap_[0] + size_;
+        }
+
+        // What is written to the spill area of a truncated line is dropped
+        void commit(const char* end) {
+            if (storage_ != Storage::TRUNCATED)
+                size_ = static_cast<size_t>(end - data());
+        }
+
+        const char* data() const {
+            return storage_ == Storage::HEAP ? heap_.data() : inline_;
+        }
+
+        std::string_view view() const {
+            return std::string_view(data(), size_);
+        }
+
+        /*
+         * Keeps the lines in the inline array: reservations that do not fit
+         * are given spill, which must hold the largest one, as the 320 and
+         * more characters of a fixed-point number, and the line is truncated.
+         */
+        void bound(char* spill) {
+            spill_ = spill;
+        }
+
+        bool isTruncated() const {
+            return storage_ == Storage::TRUNCATED;
+        }
+
+        // Ends the line, a bounded one losing its last character if it is full
+        void endLine() {
+            if (!spill_)
+                append('\n');
+            else if (size_ < sizeof(inline_))
+                inline_[size_++] = '\n';
+            else
+                inline_[size_ - 1] = '\n';
+        }
+
+    private:
+        enum class Storage : unsigned char { INLINE, HEAP, TRUNCATED };
+
+        char        inline_[TINYLOGGER_FORMAT_BUFFER_SIZE];
+        size_t      size_    = 0;
+        Storage     storage_ = Storage::INLINE;
+        char*       spill_   = nullptr;
+        std::string heap_;
+    };
+
+    // Every thread formats its lines in its own buffer
+    inline FormatBuffer& threadFormatBuffer() {
+        thread_local FormatBuffer buffer;
+        return buffer;
+    }
+
+    // And renders the timestamps with its own cache, so without any lock
+    inline TimestampCache& threadTimestampCache() {
+        thread_local TimestampCache timestampCache;
+        return timestampCache;
+    }
+
+    // Tick of the previous record of the thread, see TickClock
+    inline uint64_t& threadLastLogTime() {
+        thread_local uint64_t lastLogTime = 0;
+        return lastLogTime;
+    }
+
+    inline ClockCalibration& threadClockCalibration() {
+        thread_local ClockCalibration clockCalibration;
+        return clockCalibration;
+    }
+
+    template <typename T>
+    inline constexpr bool isCharacter = std::is_same_v<T, char> || std::is_same_v<T, signed char> || std::is_same_v<T, unsigned char>;
+
+    template <typename T, typename = void>
+    inline constexpr bool isStreamable = false;
+
+    template <typename T>
+    inline constexpr bool isStreamable<T, std::void_t<decltype(std::declval<std::ostream&>() << std::declval<const T&>())>> = true;
+
+    template <typename T>
+    inline constexpr bool isDuration = false;
+
+    template <typename Rep, typename Period>
+    inline constexpr bool isDuration<std::chrono::duration<Rep, Period>> = true;
+
+    // Pointers printed as addresses, and not as strings or as booleans
+    template <typename T>
+    inline constexpr bool isObjectPointer = std::is_pointer_v<T> && !isCharacter<std::remove_cv_t<std::remove_pointer_t<T>>> &&
+                                            !std::is_function_v<std::remove_pointer_t<T>>;
+
+    // Suffix of a duration, as printed by C++20, or nullptr for another period
+    template <typename Period>
+    constexpr const char* durationSuffix() {
+        if constexpr (std::is_same_v<Period, std::nano>)            return "ns";
+        else if constexpr (std::is_same_v<Period, std::micro>)      return "us";
+        else if constexpr (std::is_same_v<Period, std::milli>)      return "ms";
+        else if constexpr (std::is_same_v<Period, std::ratio<1>>)     return "s";
+        else if constexpr (std::is_same_v<Period, std::ratio<60>>)    return "min";
+        else if constexpr (std::is_same_v<Period, std::ratio<3600>>)  return "h";
+        else if constexpr (std::is_same_v<Period, std::ratio<86400>>) return "d";
+        else                                                          return nullptr;
+    }
+
+} // namespace detail
+
+
+    /*
+     * =========================================================================
+     *                               Formatters
+     * =========================================================================
+     *
+     * Arguments are appended to the line by tl::formatter<T>::format, with T
+     * the decayed type of the argument. The built-in formatters write in the
+     * buffer directly: numbers with std::to_chars, strings, enumerations as
+     * their underlying value, std::chrono durations with their unit, as
+     * "250ms", and pointers in hexadecimal. Types without formatter are
+     * streamed with operator<< into an std::ostringstream.
+     *
+     * A formatter is added by specialising the template:
+     *
+     *     template <> struct tl::formatter<Point> {
+     *         static constexpr bool isDeferrable = true;
+     *         static void format(tl::FormatBuffer& buffer, const Point& point) {
+     *             buffer.append('(');
+     *             tl::formatter<int>::format(buffer, point.x);
+     *             ...
+     *         }
+     *     };
+     *
+     * isDeferrable lets the asynchronous mode copy the values, which must be
+     * trivially copyable and not reference memory, and format them on the
+     * backend. Without it, records holding them are formatted by the caller.
+     */
+
+    // Buffer the formatters append to, see detail::FormatBuffer
+    using FormatBuffer = detail::FormatBuffer;
+
+    template <typename T, typename = void>
+    struct formatter {};
+
+    template <>
+    struct formatter<bool> {
+        static void format(FormatBuffer& buffer, bool value) {
+            buffer.append(value ? '1' : '0');
+        }
+    };
+
+    template <typename T>
+    struct formatter<T, std::enable_if_t<detail::isCharacter<T>>> {
+        static void format(FormatBuffer& buffer, T value) {
+            buffer.append(static_cast<char>(value));
+        }
+    };
+
+    template <typename T>
+    struct formatter<T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool> && !detail::isCharacter<T>>> {
+        static void format(FormatBuffer& buffer, T value) {
+            char* cursor = buffer.reserve(24);
+            buffer.commit(std::to_chars(cursor, cursor + 24, value).ptr);
+        }
+    };
+
+    template <typename T>
+    struct formatter<T, std::enable_if_t<std::is_floating_point_v<T>>> {
+        static void format(FormatBuffer& buffer, T value) {
+            // Same output as the default std::ostream precision of 6 digits
+            char* cursor = buffer.reserve(64);
+            #if defined(__cpp_lib_to_chars)
+                buffer.commit(std::to_chars(cursor, cursor + 64, value, std::chars_format::general, 6).ptr);
+            #else
+                buffer.commit(cursor + std::snprintf(cursor, 64, "%g", static_cast<double>(value)));
+            #endif
+        }
+    };
+
+    template <>
+    struct formatter<StaticString> {
+        static void format(FormatBuffer& buffer, const StaticString& value) {
+            buffer.append(std::string_view(value.data, value.size));
+        }
+    };
+
+    // Null C strings are skipped, instead of failing the stream
+    template <>
+    struct formatter<const char*> {
+        static void format(FormatBuffer& buffer, const char* value) {
+            if (value)
+                buffer.append(std::string_view(value));
+        }
+    };
+
+    template <>
+    struct formatter<char*> : formatter<const char*> {};
+
+    // std::string, std::string_view, and the other classes viewed as strings
+    template <typename T>
+    struct formatter<T, std::enable_if_t<std::is_class_v<T> && std::is_convertible_v<const T&, std::string_view>>> {
+        static void format(FormatBuffer& buffer, const T& value) {
+            buffer.append(std::string_view(value));
+        }
+    };
+
+    // Enumerations without operator<<, the others keeping their own
+    template <typename T>
+    struct formatter<T, std::enable_if_t<std::is_enum_v<T> && !detail::isStreamable<T>>> {
+        static void format(FormatBuffer& buffer, T value) {
+            formatter<std::underlying_type_t<T>>::format(buffer, static_cast<std::underlying_type_t<T>>(value));
+        }
+    };
+
+    template <typename Rep, typename Period>
+    struct formatter<std::chrono::duration<Rep, Period>> {
+        static void format(FormatBuffer& buffer, const std::chrono::duration<Rep, Period>& value) {
+            formatter<Rep>::format(buffer, value.count());
+            if constexpr (detail::durationSuffix<Period>() != nullptr)
+                buffer.append(detail::durationSuffix<Period>());
+            else {
+                buffer.append('[');
+                formatter<std::intmax_t>::format(buffer, Period::num);
+                if constexpr (Period::den != 1) {
+                    buffer.append('/');
+                    formatter<std::intmax_t>::format(buffer, Period::den);
+                }
+                buffer.append("]s");
+            }
+        }
+    };
+
+    // Object pointers in hexadecimal, character pointers being strings
+    template <typename T>
+    struct formatter<T*, std::enable_if_t<detail::isObjectPointer<T*>>> {
+        static void format(FormatBuffer& buffer, const T* value) {
+            char* cursor = buffer.reserve(2 + 2 * sizeof(void*));
+            cursor[0]    = '0';
+            cursor[1]    = 'x';
+            buffer.commit(std::to_chars(cursor + 2, cursor + 2 + 2 * sizeof(void*), reinterpret_cast<std::uintptr_t>(value), 16).ptr);
+        }
+    };
+
+    template <>
+    struct formatter<std::nullptr_t> {
+        static void format(FormatBuffer& buffer, std::nullptr_t) {
+            buffer.append("nullptr");
+        }
+    };
+
+namespace detail {
+
+    template <typename T, typename = void>
+    inline constexpr bool hasFormatter = false;
+
+    template <typename T>
+    inline constexpr bool hasFormatter<T, std::void_t<decltype(formatter<T>::format(std::declval<FormatBuffer&>(), std::declval<const T&>()))>> = true;
+
+    // Formatters whose values can be copied into a record, and formatted later
+    template <typename T, typename = void>
+    inline constexpr bool isFormatterDeferrable = false;
+
+    template <typename T>
+    inline constexpr bool isFormatterDeferrable<T, std::enable_if_t<formatter<T>::isDeferrable>> = std::is_trivially_copyable_v<T>;
+
+    /*
+     * @brief Appends value to buffer with its tl::formatter, giving the same
+     *        text as operator<< for the types both handle. Types without
+     *        formatter are streamed into an std::ostringstream.
+     */
+    template <typename T>
+    INLINING_TINYLOGGER void appendArgument(FormatBuffer& buffer, const T& value) {
+        using Type = std::decay_t<T>;
+
+        if constexpr (hasFormatter<Type>)
+            formatter<Type>::format(buffer, value);
+        else {
+            std::ostringstream stream;
+            stream << value;
+            buffer.append(stream.str());
+        }
+    }
+
+    /*
+     * @brief Copies an argument into a record payload, and renders it later.
+     *
+     * encode writes the binary representation of the value at cursor, which
+     * is advanced, and returns false if it would go past end. decode appends
+     * the value read at cursor and returns the position of the next argument.
+     * encodeBinary does the same as decode, for the binary log format.
+     * Types without specialisation are not deferrable, and records that hold
+     * any of them are formatted on the caller thread.
+     */
+    template <typename T, typename = void>
+    struct ArgCodec {
+        static constexpr bool isDeferrable = false;
+    };
+
+    // Integral and floating point values are copied as they are in memory
+    template <typename T>
+    struct ArgCodec<T, std::enable_if_t<std::is_arithmetic_v<T>>> {
+        static constexpr bool isDeferrable = true;
+
+        static bool encode(char*& cursor, const char* end, T value) {
+            if (static_cast<size_t>(end - cursor) < sizeof(T))
+                return false;
+            std::memcpy(cursor, &value, sizeof(T));
+            cursor += sizeof(T);
+            return true;
+        }
+
+        static const char* decode(const char* cursor, FormatBuffer& buffer) {
+            T value;
+            std::memcpy(&value, cursor, sizeof(T));
+            appendArgument(buffer, value);
+            return cursor + sizeof(T);
+        }
+
+        static const char* encodeBinary(const char* cursor, BinaryEncoder& encoder) {
+            T value;
+            std::memcpy(&value, cursor, sizeof(T));
+            encoder.writeArithmetic(value);
+            return cursor + sizeof(T);
+        }
+
+        // Calls function with the value read at cursor, for custom rendering
+        template <typename Function>
+        static const char* visit(const char* cursor, Function&& function) {
+            T value;
+            std::memcpy(&value, cursor, sizeof(T));
+            function(value);
+            return cursor + sizeof(T);
+        }
+    };
+
+    // Strings whose lifetime is unknown are copied with their size as prefix
+    struct StringCodec {
+        static constexpr bool isDeferrable = true;
+
+        static bool encode(char*& cursor, const char* end, std::string_view value) {
+            if (static_cast<size_t>(end - cursor) < sizeof(size_t) + value.size())
+                return false;
+            const size_t size = value.size();
+            std::memcpy(cursor, &size, sizeof(size_t));
+            std::memcpy(cursor + sizeof(size_t), value.data(), size);
+            cursor += sizeof(size_t) + size;
+            return true;
+        }
+
+        static const char* decode(const char* cursor, FormatBuffer& buffer) {
+            size_t size;
+            std::memcpy(&size, cursor, sizeof(size_t));
+            buffer.append(std::string_view(cursor + sizeof(size_t), size));
+            return cursor + sizeof(size_t) + size;
+        }
+
+        static const char* encodeBinary(const char* cursor, BinaryEncoder& encoder) {
+            size_t size;
+            std::memcpy(&size, cursor, sizeof(size_t));
+            encoder.writeString(std::string_view(cursor + sizeof(size_t), size));
+            return cursor + sizeof(size_t) + size;
+        }
+
+        template <typename Function>
+        static const char* visit(const char* cursor, Function&& function) {
+            size_t size;
+            std::memcpy(&size, cursor, sizeof(size_t));
+            function(std::string_view(cursor + sizeof(size_t), size));
+            return cursor + sizeof(size_t) + size;
+        }
+    };
+
+    // Enumerations, durations, pointers, and types whose formatter allows it
+    template <typename T>
+    inline constexpr bool isCopiedAsIs = !std::is_arithmetic_v<T> && std::is_trivially_copyable_v<T> &&
+                                         (std::is_enum_v<T> || isDuration<T> || isObjectPointer<T> || isFormatterDeferrable<T>);
+
+    // Copied as they are in memory, and rendered by their formatter on the backend
+    template <typename T>
+    struct ArgCodec<T, std::enable_if_t<isCopiedAsIs<T>>> {
+        static constexpr bool isDeferrable = true;
+
+        static bool encode(char*& cursor, const char* end, const T& value) {
+            if (static_cast<size_t>(end - cursor) < sizeof(T))
+                return false;
+            std::memcpy(cursor, &value, sizeof(T));
+            cursor += sizeof(T);
+            return true;
+        }
+
+        static const char* decode(const char* cursor, FormatBuffer& buffer) {
+            return visit(cursor, [&buffer](const T& value) { appendArgument(buffer, value); });
+        }
+
+        // The binary log stores the rendered text, as it has no tag for them
+        static const char* encodeBinary(const char* cursor, BinaryEncoder& encoder) {
+            FormatBuffer text;
+            cursor = decode(cursor, text);
+            encoder.writeString(text.view());
+            return cursor;
+        }
+
+        template <typename Function>
+        static const char* visit(const char* cursor, Function&& function) {
+            alignas(T) unsigned char storage[sizeof(T)];
+            std::memcpy(storage, cursor, sizeof(T));
+            function(*std::launder(reinterpret_cast<const T*>(storage)));
+            return cursor + sizeof(T);
+        }
+    };
+
+    template <> struct ArgCodec<const char*>      : StringCodec {};
+    template <> struct ArgCodec<char*>            : StringCodec {};
+    template <> struct ArgCodec<std::string>      : StringCodec {};
+    template <> struct ArgCodec<std::string_view> : StringCodec {};
+
+    // Static strings are only referenced, since they outlive every record
+    template <>
+    struct ArgCodec<StaticString> {
+        static constexpr bool isDeferrable = true;
+
+        static bool encode(char*& cursor, const char* end, const StaticString& value) {
+            if (static_cast<size_t>(end - cursor) < sizeof(StaticString))
+                return false;
+            std::memcpy(cursor, &value, sizeof(StaticString));
+            cursor += sizeof(StaticString);
+            return true;
+        }
+
+        static const char* decode(const char* cursor, FormatBuffer& buffer) {
+            StaticString value("");
+            std::memcpy(&value, cursor, sizeof(StaticString));
+            appendArgument(buffer, value);
+            return cursor + sizeof(StaticString);
+        }
+
+        static const char* encodeBinary(const char* cursor, BinaryEncoder& encoder) {
+            StaticString value("");
+            std::memcpy(&value, cursor, sizeof(StaticString));
+            encoder.writeStaticString(value.data, value.size);
+            return cursor + sizeof(StaticString);
+        }
+
+        template <typename Function>
+        static const char* visit(const char* cursor, Function&& function) {
+            StaticString value("");
+            std::memcpy(&value, cursor, sizeof(StaticString));
+            function(value);
+            return cursor + sizeof(StaticString);
+        }
+    };
+
+    template <typename... Args>
+    inline constexpr bool areDeferrable = (ArgCodec<std::decay_t<Args>>::isDeferrable && ...);
+
+    template <typename... Args>
+    void decodePayload(const char* payload, FormatBuffer& buffer) {
+        const char* cursor = payload;
+        ((cursor = ArgCodec<Args>::decode(cursor, buffer)), ...);
+        (void)cursor;
+    }
+
+    template <typename... Args>
+    void encodeBinaryPayload(const char* payload, BinaryEncoder& encoder) {
+        const char* cursor = payload;
+        ((cursor = ArgCodec<Args>::encodeBinary(cursor, encoder)), ...);
+        (void)cursor;
+    }
+
+    // Type-erased formatters: one instance per argument types sequence
+    struct PayloadFormat {
+        size_t argumentCount;
+        void (*decode)      (const char* payload, FormatBuffer&  buffer);
+        void (*encodeBinary)(const char* payload, BinaryEncoder& encoder);
+    };
+
+    // Entries written in the binary log for an argument, see FormattedMessage
+    template <typename T>
+    inline constexpr size_t binaryArgumentCount = 1;
+
+    template <typename... Args>
+    inline constexpr PayloadFormat payloadFormat = { (binaryArgumentCount<Args> + ... + 0), &decodePayload<Args...>, &encodeBinaryPayload<Args...> };
+
+    // Encodes the arguments from cursor, which is advanced, up to end
+    template <typename... Args>
+    INLINING_TINYLOGGER bool encodeArguments(char*& cursor, const char* end, const Args&... args) {
+        return (ArgCodec<std::decay_t<Args>>::encode(cursor, end, args) && ...);
+    }
+
+    template <typename... Args>
+    INLINING_TINYLOGGER bool encodePayload(char* payload, size_t capacity, const Args&... args) {
+        char* cursor = payload;
+        return encodeArguments(cursor, payload + capacity, args...);
+    }
+
+} // namespace detail
+
+
+    /*
+     * =========================================================================
+     *                        Compile-time Format Strings
+     * =========================================================================
+     *
+     * The LOG_<LEVEL>F macros take a format string, as "x={} y={:.3f}", whose
+     * fields are replaced by the arguments in order. A field is {} or holds a
+     * specification {:[[fill]align][0][width][.precision][type]}, with:
+     *  - align    : '<' left, '>' right, '^' centered
+     *  - type     : 'd', 'x', 'X', 'o', 'b' and 'c' for the integers,
+     *               'f', 'F', 'e', 'E', 'g' and 'G' for the floating points,
+     *               's' for the strings
+     * Braces are escaped by doubling them, as "{{" and "}}".
+     *
+     * The format string is parsed during the compilation: the number of
+     * fields and the types of the arguments are checked by static_assert,
+     * and every field is rendered by a function specialised for its spec.
+     * Nothing is parsed at runtime, including when records are deferred.
+     * With C++20, the parser is consteval, and fields with the same spec
+     * share their rendering function, whatever their format string.
+     */
+
+#if defined(__cpp_consteval)
+#   define TL_CONSTEVAL consteval
+#else
+#   define TL_CONSTEVAL constexpr
+#endif
+
+namespace detail {
+
+    // Specification of a replacement field, "{:>8.3f}" giving '>', 8, 3, 'f'
+    struct FormatSpec {
+        char fill      = ' ';
+        char align     = '\0';
+        bool zeroPad   = false;
+        int  width     = 0;
+        int  precision = -1;
+        char type      = '\0';
+
+        constexpr bool isDefault() const {
+            return align == '\0' && !zeroPad && width == 0 && precision < 0 && type == '\0';
+        }
+    };
+
+    // Literal text of a format string, followed by a replacement field or not
+    struct FormatPiece {
+        size_t     literalBegin = 0;
+        size_t     literalSize  = 0;
+        bool       hasField     = false;
+        FormatSpec spec;
+    };
+
+    enum class FormatError {
+        NONE,
+        UNMATCHED_OPEN_BRACE,
+        UNMATCHED_CLOSE_BRACE,
+        POSITIONAL_FIELD,
+        INVALID_SPEC
+    };
+
+    struct FormatLayout {
+        size_t      pieceCount = 0;
+        size_t      fieldCount = 0;
+        FormatError error      = FormatError::NONE;
+    };
+
+    TL_CONSTEVAL bool isDigit(char character) {
+        return character >= '0' && character <= '9';
+    }
+
+    // Parses the spec that starts at position, returns the position of its closing brace or npos
+    TL_CONSTEVAL size_t parseFormatSpec(std::string_view format, size_t position, FormatSpec& spec) {
+        const auto isAlign = [](char character) { return character == '<' || character == '>' || character == '^'; };
+        const auto isType  = [](char character) { return std::string_view("dxXobcfFeEgGs").find(character) != std::string_view::npos; };
+
+        if (position + 1 < format.size() && format[position] != '}' && isAlign(format[position + 1])) {
+            spec.fill  = format[position];
+            spec.align = format[position + 1];
+            position  += 2;
+        }
+        else if (position < format.size() && isAlign(format[position]))
+            spec.align = format[position++];
+
+        if (position < format.size() && format[position] == '0') {
+            spec.zeroPad = true;
+            ++position;
+        }
+        while (position < format.size() && isDigit(format[position]))
+            spec.width = 10 * spec.width + (format[position++] - '0');
+
+        if (position < format.size() && format[position] == '.') {
+            if (++position >= format.size() || !isDigit(format[position]))
+                return std::string_view::npos;
+            spec.precision = 0;
+            while (position < format.size() && isDigit(format[position]))
+                spec.precision = 10 * spec.precision + (format[position++] - '0');
+        }
+
+        if (position < format.size() && isType(format[position]))
+            spec.type = format[position++];
+
+        return position < format.size() && format[position] == '}' ? position : std::string_view::npos;
+    }
+
+    TL_CONSTEVAL void addFormatPiece(FormatPiece* pieces, FormatLayout& layout, size_t literalBegin, size_t literalSize,
+                                     bool hasField, const FormatSpec& spec) {
+        if (pieces) {
+            pieces[layout.pieceCount].literalBegin = literalBegin;
+            pieces[layout.pieceCount].literalSize  = literalSize;
+            pieces[layout.pieceCount].hasField     = hasField;
+            pieces[layout.pieceCount].spec         = spec;
+        }
+        ++layout.pieceCount;
+        if (hasField)
+            ++layout.fieldCount;
+    }
+
+    /*
+     * @brief Splits format into pieces, written to pieces unless it is null,
+     *        and returns their count. A doubled brace ends a literal, after
+     *        its first character, and the second one is skipped.
+     */
+    TL_CONSTEVAL FormatLayout parseFormat(std::string_view format, FormatPiece* pieces) {
+        FormatLayout layout;
+        size_t       literalBegin = 0;
+        size_t       position     = 0;
+
+        while (position < format.size()) {
+            const char character = format[position];
+            if (character != '{' && character != '}') {
+                ++position;
+                continue;
+            }
+
+            if (position + 1 < format.size() && format[position + 1] == character) {
+                addFormatPiece(pieces, layout, literalBegin, position + 1 - literalBegin, false, FormatSpec());
+                position    += 2;
+                literalBegin = position;
+                continue;
+            }
+            if (character == '}') {
+                layout.error = FormatError::UNMATCHED_CLOSE_BRACE;
+                return layout;
+            }
+
+            FormatSpec spec;
+            size_t     end = position + 1;
+            if (end < format.size() && format[end] == ':')
+                end = parseFormatSpec(format, end + 1, spec);
+            else if (end >= format.size() || format[end] != '}') {
+                layout.error = end < format.size() && isDigit(format[end]) ? FormatError::POSITIONAL_FIELD
+                                                                           : FormatError::UNMATCHED_OPEN_BRACE;
+                return layout;
+            }
+            if (end == std::string_view::npos) {
+                layout.error = FormatError::INVALID_SPEC;
+                return layout;
+            }
+
+            addFormatPiece(pieces, layout, literalBegin, position - literalBegin, true, spec);
+            position     = end + 1;
+            literalBegin = position;
+        }
+
+        if (literalBegin < format.size())
+            addFormatPiece(pieces, layout, literalBegin, format.size() - literalBegin, false, FormatSpec());
+        return layout;
+    }
+
+    template <size_t N>
+    TL_CONSTEVAL std::array<FormatPiece, N> parseFormatPieces(std::string_view format) {
+        std::array<FormatPiece, N> pieces{};
+        parseFormat(format, pieces.data());
+        return pieces;
+    }
+
+    /*
+     * @brief Pieces of the format string held by FormatString, a type whose
+     *        static value() returns it, as made by TL_FORMAT_STRING.
+     */
+    template <typename FormatString>
+    struct ParsedFormat {
+        static constexpr std::string_view format = FormatString::value();
+        static constexpr FormatLayout     layout = parseFormat(format, nullptr);
+        static constexpr auto             pieces = parseFormatPieces<layout.pieceCount>(format);
+
+        // Index of the argument replacing the field of the given piece
+        static constexpr size_t argumentIndex(size_t piece) {
+            size_t index = 0;
+            for (size_t i = 0; i < piece; ++i)
+                index += pieces[i].hasField ? 1 : 0;
+            return index;
+        }
+
+        static constexpr size_t nonEmptyLiteralCount() {
+            size_t count = 0;
+            for (const FormatPiece& piece : pieces)
+                count += piece.literalSize > 0 ? 1 : 0;
+            return count;
+        }
+    };
+
+    template <typename T>
+    inline constexpr bool isFormatText = std::is_same_v<T, StaticString> || std::is_same_v<T, std::string_view> ||
+                                         std::is_same_v<T, std::string>  || std::is_same_v<T, const char*>      ||
+                                         std::is_same_v<T, char*>;
+
+    template <typename T>
+    inline constexpr bool isFormatCharacter = std::is_same_v<T, char> || std::is_same_v<T, signed char> || std::is_same_v<T, unsigned char>;
+
+    // Tells whether a field with this spec can render a value of type T
+    template <typename T>
+    constexpr bool acceptsFormatSpec(const FormatSpec& spec) {
+        constexpr bool isInteger = std::is_integral_v<T> && !std::is_same_v<T, bool>;
+
+        if (spec.zeroPad && !std::is_arithmetic_v<T>)
+            return false;
+        switch (spec.type) {
+            case 'd': case 'x': case 'X': case 'o': case 'b': case 'c':
+                return isInteger && spec.precision < 0;
+            case 'f': case 'F': case 'e': case 'E': case 'g': case 'G':
+                return std::is_floating_point_v<T>;
+            case 's':
+                return isFormatText<T>;
+            default:
+                return spec.precision < 0 || std::is_floating_point_v<T> || isFormatText<T>;
+        }
+    }
+
+    template <typename FormatString, size_t Piece, typename... Args>
+    constexpr bool acceptsPieceSpec() {
+        using Parsed = ParsedFormat<FormatString>;
+        if constexpr (Parsed::pieces[Piece].hasField)
+            return acceptsFormatSpec<std::tuple_element_t<Parsed::argumentIndex(Piece), std::tuple<Args...>>>(Parsed::pieces[Piece].spec);
+        else
+            return true;
+    }
+
+    // Only checked once the format is valid, and has one field per argument
+    template <typename FormatString, typename... Args, size_t... Pieces>
+    constexpr bool acceptsFormatSpecs(std::index_sequence<Pieces...>) {
+        using Parsed = ParsedFormat<FormatString>;
+        if constexpr (Parsed::layout.error != FormatError::NONE || Parsed::layout.fieldCount != sizeof...(Args))
+            return true;
+        else
+            return (acceptsPieceSpec<FormatString, Pieces, Args...>() && ...);
+    }
+
+    // Spec of the field of a piece, given to appendField as a type
+    template <typename FormatString, size_t Piece>
+    struct PieceSpec {
+        static constexpr FormatSpec value = ParsedFormat<FormatString>::pieces[Piece].spec;
+    };
+
+#if defined(__cpp_nontype_template_args) && __cpp_nontype_template_args >= 201911L
+    template <FormatSpec Spec>
+    struct SharedSpec {
+        static constexpr FormatSpec value = Spec;
+    };
+
+    template <typename FormatString, size_t Piece>
+    using FieldSpec = SharedSpec<PieceSpec<FormatString, Piece>::value>;
+#else
+    template <typename FormatString, size_t Piece>
+    using FieldSpec = PieceSpec<FormatString, Piece>;
+#endif
+
+    // Pads the field that starts at begin to the width of its spec
+    inline void padField(FormatBuffer& buffer, size_t begin, const FormatSpec& spec, bool isNumber) {
+        const size_t size  = buffer.view().size() - begin;
+        const size_t width = static_cast<size_t>(spec.width);
+        if (size >= width)
+            return;
+
+        const size_t padding = width - size;
+        char*        end     = buffer.reserve(padding);
+        if (buffer.isTruncated())
+            return; // The field is not followed by the room to pad it
+
+        char* field = end - size;
+
+        if (spec.zeroPad && !spec.align && isNumber) {
+            // Zeros go between the sign and the digits
+            const size_t sign = size > 0 && (field[0] == '-' || field[0] == '+') ? 1 : 0;
+            std::memmove(field + sign + padding, field + sign, size - sign);
+            std::memset(field + sign, '0', padding);
+        }
+        else {
+            const char   align  = spec.align ? spec.align : (isNumber ? '>' : '<');
+            const size_t before = align == '>' ? padding : align == '^' ? padding / 2 : 0;
+            std::memmove(field + before, field, size);
+            std::memset(field, spec.fill, before);
+            std::memset(field + before + size, spec.fill, padding - before);
+        }
+        buffer.commit(end + padding);
+    }
+
+    /*
+     * @brief Appends value as requested by Spec::value. The spec being known
+     *        at compile time, only the code of the requested rendering is kept.
+     */
+    template <typename Spec, typename T>
+    INLINING_TINYLOGGER void appendField(FormatBuffer& buffer, const T& value) {
+        using Type = std::decay_t<T>;
+        constexpr FormatSpec spec = Spec::value;
+
+        if constexpr (spec.isDefault())
+            appendArgument(buffer, value);
+        else {
+            const size_t   begin    = buffer.view().size();
+            constexpr bool isNumber = std::is_arithmetic_v<Type> && !std::is_same_v<Type, bool> && spec.type != 'c' &&
+                                      !(isFormatCharacter<Type> && spec.type == '\0');
+
+            if constexpr (std::is_integral_v<Type> && isNumber) {
+                constexpr int base = spec.type == 'x' || spec.type == 'X' ? 16 : spec.type == 'o' ? 8 : spec.type == 'b' ? 2 : 10;
+
+                char* cursor = buffer.reserve(72);
+                char* end    = std::to_chars(cursor, cursor + 72, value, base).ptr;
+                if constexpr (spec.type == 'X')
+                    for (char* digit = cursor; digit != end; ++digit)
+                        if (*digit >= 'a' && *digit <= 'f')
+                            *digit = static_cast<char>(*digit - 'a' + 'A');
+                buffer.commit(end);
+            }
+            else if constexpr (std::is_integral_v<Type> && !std::is_same_v<Type, bool>)
+                buffer.append(static_cast<char>(value));
+            else if constexpr (std::is_floating_point_v<Type>) {
+                constexpr int    precision = spec.precision < 0 ? 6 : spec.precision;
+                constexpr char   type      = spec.type == '\0' ? 'g' : spec.type;
+                constexpr size_t capacity  = 320 + static_cast<size_t>(precision);
+
+                char* cursor = buffer.reserve(capacity);
+                char* end;
+                #if defined(__cpp_lib_to_chars)
+                    constexpr std::chars_format chars = type == 'f' || type == 'F' ? std::chars_format::fixed
+                                                      : type == 'e' || type == 'E' ? std::chars_format::scientific
+                                                      :                              std::chars_format::general;
+                    end = std::to_chars(cursor, cursor + capacity, value, chars, precision).ptr;
+                #else
+                    const char conversion[] = { '%', '.', '*', type, '\0' };
+                    end = cursor + std::snprintf(cursor, capacity, conversion, precision, static_cast<double>(value));
+                #endif
+                if constexpr (type == 'F' || type == 'E' || type == 'G')
+                    for (char* character = cursor; character != end; ++character)
+                        if (*character >= 'a' && *character <= 'z')
+                            *character = static_cast<char>(*character - 'a' + 'A');
+                buffer.commit(end);
+            }
+            else if constexpr (isFormatText<Type>) {
+                std::string_view text;
+                if constexpr (std::is_same_v<Type, StaticString>)
+                    text = std::string_view(value.data, value.size);
+                else if constexpr (std::is_pointer_v<Type>)
+                    text = value ? std::string_view(value) : std::string_view();
+                else
+                    text = std::string_view(value);
+
+                if constexpr (spec.precision >= 0)
+                    text = text.substr(0, static_cast<size_t>(spec.precision));
+                buffer.append(text);
+            }
+            else
+                appendArgument(buffer, value);
+
+            if constexpr (spec.width > 0)
+                padField(buffer, begin, spec, isNumber);
+        }
+    }
+
+    // Arithmetic values and pointers are copied, others are referenced
+    template <typename T>
+    using FormatStorage = std::conditional_t<std::is_arithmetic_v<T> || std::is_pointer_v<T>, T, const T&>;
+
+    /*
+     * @brief Arguments of a format string, as a single argument of the log
+     *        functions. Args are the decayed types of the arguments, which
+     *        are only referenced until the record is formatted or deferred.
+     */
+    template <typename FormatString, typename... Args>
+    struct FormattedMessage {
+        using Parsed = ParsedFormat<FormatString>;
+
+        std::tuple<FormatStorage<Args>...> arguments;
+
+        template <size_t Piece>
+        static void appendLiteral(FormatBuffer& buffer) {
+            constexpr FormatPiece piece = Parsed::pieces[Piece];
+            if constexpr (piece.literalSize > 0)
+                buffer.append(Parsed::format.substr(piece.literalBegin, piece.literalSize));
+        }
+
+        template <size_t Piece>
+        using ArgumentOf = std::tuple_element_t<Parsed::argumentIndex(Piece), std::tuple<Args...>>;
+    };
+
+    template <typename FormatString, typename... Args, size_t... Pieces>
+    INLINING_TINYLOGGER void appendFormattedMessage(FormatBuffer& buffer, const FormattedMessage<FormatString, Args...>& message,
+                                                    std::index_sequence<Pieces...>) {
+        using Message = FormattedMessage<FormatString, Args...>;
+        using Parsed  = typename Message::Parsed;
+
+        const auto appendPiece = [&buffer, &message](auto piece) {
+            constexpr size_t Piece = decltype(piece)::value;
+            Message::template appendLiteral<Piece>(buffer);
+            if constexpr (Parsed::pieces[Piece].hasField)
+                appendField<FieldSpec<FormatString, Piece>>(buffer, std::get<Parsed::argumentIndex(Piece)>(message.arguments));
+        };
+        (appendPiece(std::integral_constant<size_t, Pieces>()), ...);
+    }
+
+    // Formatted messages are rendered piece by piece, instead of being streamed
+    template <typename FormatString, typename... Args>
+    INLINING_TINYLOGGER void appendArgument(FormatBuffer& buffer, const FormattedMessage<FormatString, Args...>& message) {
+        appendFormattedMessage(buffer, message, std::make_index_sequence<ParsedFormat<FormatString>::layout.pieceCount>());
+    }
+
+    /*
+     * @brief Deferred formatted messages only store their arguments, and the
+     *        pieces of the format are rendered from the type of the message.
+     *        The binary log gets its non-empty literals as static strings,
+     *        then the raw fields, or the rendered ones when they have a spec.
+     */
+    template <typename FormatString, typename... Args>
+    struct ArgCodec<FormattedMessage<FormatString, Args...>> {
+        using Message = FormattedMessage<FormatString, Args...>;
+        using Parsed  = typename Message::Parsed;
+        using Pieces  = std::make_index_sequence<Parsed::layout.pieceCount>;
+
+        static constexpr bool isDeferrable = areDeferrable<Args...>;
+
+        static bool encode(char*& cursor, const char* end, const Message& message) {
+            return std::apply([&cursor, end](const auto&... arguments) {
+                return (ArgCodec<Args>::encode(cursor, end, arguments) && ...);
+            }, message.arguments);
+        }
+
+        static const char* decode(const char* cursor, FormatBuffer& buffer) {
+            return decodePieces(cursor, buffer, Pieces());
+        }
+
+        static const char* encodeBinary(const char* cursor, BinaryEncoder& encoder) {
+            return encodeBinaryPieces(cursor, encoder, Pieces());
+        }
+
+    private:
+        template <size_t... Indices>
+        static const char* decodePieces(const char* cursor, FormatBuffer& buffer, std::index_sequence<Indices...>) {
+            ((cursor = decodePiece<Indices>(cursor, buffer)), ...);
+            return cursor;
+        }
+
+        template <size_t Piece>
+        static const char* decodePiece(const char* cursor, FormatBuffer& buffer) {
+            Message::template appendLiteral<Piece>(buffer);
+            if constexpr (Parsed::pieces[Piece].hasField)
+                return ArgCodec<typename Message::template ArgumentOf<Piece>>::visit(cursor, [&buffer](const auto& value) {
+                    appendField<FieldSpec<FormatString, Piece>>(buffer, value);
+                });
+            else
+                return cursor;
+        }
+
+        template <size_t... Indices>
+        static const char* encodeBinaryPieces(const char* cursor, BinaryEncoder& encoder, std::index_sequence<Indices...>) {
+            ((cursor = encodeBinaryPiece<Indices>(cursor, encoder)), ...);
+            return cursor;
+        }
+
+        template <size_t Piece>
+        static const char* encodeBinaryPiece(const char* cursor, BinaryEncoder& encoder) {
+            constexpr FormatPiece piece = Parsed::pieces[Piece];
+            if constexpr (piece.literalSize > 0)
+                encoder.writeStaticString(Parsed::format.data() + piece.literalBegin, piece.literalSize);
+
+            if constexpr (!piece.hasField)
+                return cursor;
+            else if constexpr (piece.spec.isDefault())
+                return ArgCodec<typename Message::template ArgumentOf<Piece>>::encodeBinary(cursor, encoder);
+            else
+                return ArgCodec<typename Message::template ArgumentOf<Piece>>::visit(cursor, [&encoder](const auto& value) {
+                    FormatBuffer field;
+                    appendField<FieldSpec<FormatString, Piece>>(field, value);
+                    encoder.writeString(field.view());
+                });
+        }
+    };
+
+    template <typename FormatString, typename... Args>
+    inline constexpr size_t binaryArgumentCount<FormattedMessage<FormatString, Args...>> =
+        ParsedFormat<FormatString>::nonEmptyLiteralCount() + sizeof...(Args);
+
+    /*
+     * @brief Checks the arguments against the format string at compile time,
+     *        and references them. The format itself is only given to skip it.
+     */
+    template <typename FormatString, typename... Args>
+    INLINING_TINYLOGGER FormattedMessage<FormatString, std::decay_t<const Args&>...> formatMessage(FormatString, const char*, const Args&... args) {
+        using Parsed = ParsedFormat<FormatString>;
+
+        static_assert(Parsed::layout.error != FormatError::UNMATCHED_OPEN_BRACE,  "TinyLogger: unmatched '{' in the format string");
+        static_assert(Parsed::layout.error != FormatError::UNMATCHED_CLOSE_BRACE, "TinyLogger: unmatched '}' in the format string");
+        static_assert(Parsed::layout.error != FormatError::POSITIONAL_FIELD,      "TinyLogger: positional fields, as {0}, are not supported");
+        static_assert(Parsed::layout.error != FormatError::INVALID_SPEC,          "TinyLogger: invalid field specification in the format string");
+        static_assert(Parsed::layout.error != FormatError::NONE || Parsed::layout.fieldCount == sizeof...(Args),
+                      "TinyLogger: the number of fields differs from the number of arguments");
+        static_assert(acceptsFormatSpecs<FormatString, std::decay_t<const Args&>...>(std::make_index_sequence<Parsed::layout.pieceCount>()),
+                      "TinyLogger: a field specification does not apply to the type of its argument");
+
+        return FormattedMessage<FormatString, std::decay_t<const Args&>...>{ std::tuple<FormatStorage<std::decay_t<const Args&>>...>(args...) };
+    }
+
+} // namespace detail
+
+    /*
+     * =========================================================================
+     *                            Structured Records
+     * =========================================================================
+     *
+     * The LOG_<LEVEL>_KV macros take a message, then fields built by tl::kv,
+     * as LOG_INFO_KV("request done", tl::kv("latency_us", x)). According to
+     * Logger::setStructuredFormat, the record is written as a JSON object,
+     * as a logfmt line, or as a text line. Level, time, elapsed time and the
+     * context enabled by LOG_FUNCTION_NAME, LOG_FILE_NAME and LOG_LINE_NUMBER
+     * are fields of their own.
+     *
+     * Keys are string literals, written as they are. Values are written into
+     * the line buffer: booleans and numbers as JSON literals, other values as
+     * escaped strings. Like the other arguments, fields are only referenced,
+     * and copied in the record payload in asynchronous mode.
+     */
+namespace detail {
+
+    // Function, file and line of a structured record, empty when disabled
+    struct SourceLocation {
+        StaticString function;
+        StaticString file;
+        uint32_t     line;
+    };
+
+    // Field of a structured record, see tl::kv
+    template <typename T>
+    struct KeyValue {
+        StaticString     key;
+        FormatStorage<T> value;
+    };
+
+    inline int countTrailingZeros(unsigned int value) {
+        #ifdef _MSC_VER
+            unsigned long index;
+            _BitScanForward(&index, value);
+            return static_cast<int>(index);
+        #else
+            return __builtin_ctz(value);
+        #endif
+    }
+
+    /*
+     * @brief Returns the first character of [cursor, end) that is escaped in
+     *        a JSON string: quote, backslash and control characters. Spaces
+     *        and '=' are also returned for logfmt, whose values are quoted
+     *        when they hold any of them. Sixteen characters are checked at
+     *        once with SSE2.
+     */
+    template <bool IsLogfmt>
+    inline const char* findSpecialCharacter(const char* cursor, const char* end) {
+        #if TINYLOGGER_USE_SSE2
+            const __m128i quote     = _mm_set1_epi8('"');
+            const __m128i backslash = _mm_set1_epi8('\\');
+            const __m128i equal     = _mm_set1_epi8(IsLogfmt ? '=' : '"');
+            const __m128i control   = _mm_set1_epi8(IsLogfmt ? ' ' : 0x1F);
+
+            for (; end - cursor >= 16; cursor += 16) {
+                const __m128i chunk   = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cursor));
+                const __m128i special = _mm_or_si128(
+                    _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+                    _mm_or_si128(_mm_cmpeq_epi8(chunk, equal), _mm_cmpeq_epi8(_mm_max_epu8(chunk, control), control)));
+
+                const int mask = _mm_movemask_epi8(special);
+                if (mask)
+                    return cursor + countTrailingZeros(static_cast<unsigned int>(mask));
+            }
+        #endif
+
+        for (; cursor != end; ++cursor) {
+            const unsigned char character = static_cast<unsigned char>(*cursor);
+            if (character <= (IsLogfmt ? ' ' : 0x1F) || character == '"' || character == '\\' || (IsLogfmt && character == '='))
+                return cursor;
+        }
+        return end;
+    }
+
+    // Appends string with the JSON escapes, runs without any being copied at once
+    template <bool IsLogfmt>
+    inline void appendEscaped(FormatBuffer& buffer, std::string_view string) {
+        static const char hexDigits[] = "0123456789abcdef";
+
+        const char* cursor = string.data();
+        const char* end    = cursor + string.size();
+        for (;;) {
+            const char* special = findSpecialCharacter<IsLogfmt>(cursor, end);
+            buffer.append(std::string_view(cursor, static_cast<size_t>(special - cursor)));
+            if (special == end)
+                return;
+
+            switch (*special) {
+                case '"':  buffer.append("\\\""); break;
+                case '\\': buffer.append("\\\\"); break;
+                case '\n': buffer.append("\\n");  break;
+                case '\r': buffer.append("\\r");  break;
+                case '\t': buffer.append("\\t");  break;
+                case ' ':
+                case '=':  buffer.append(*special); break;
+                default: {
+                    const unsigned char character = static_cast<unsigned char>(*special);
+                    const char escape[] = { '\\', 'u', '0', '0', hexDigits[character >> 4], hexDigits[character & 0xF] };
+                    buffer.append(std::string_view(escape, sizeof(escape)));
+                    break;
+                }
+            }
+            cursor = special + 1;
+        }
+    }
+
+    /*
+     * @brief Writes the fields of a structured record after its header, see
+     *        appendStructuredHeader, in the layout chosen by the caller.
+     */
+    class StructuredWriter {
+    public:
+        StructuredWriter(FormatBuffer& buffer, StructuredFormat format) : buffer_(buffer), format_(format) {}
+
+        // Same context as LOG_CONTEXT() for text lines, as "main: in [main.cpp] (l. 12) "
+        void appendLocation(const SourceLocation& location) {
+            if (format_ == StructuredFormat::TEXT) {
+                if (location.function.size) {
+                    appendArgument(buffer_, location.function);
+                    buffer_.append(':');
+                }
+                if (location.file.size) {
+                    buffer_.append(" in [");
+                    appendArgument(buffer_, location.file);
+                    buffer_.append(']');
+                }
+                if (location.line) {
+                    buffer_.append(" (l. ");
+                    appendArgument(buffer_, location.line);
+                    buffer_.append(')');
+                }
+                if (location.function.size || location.file.size || location.line)
+                    buffer_.append(' ');
+                return;
+            }
+
+            if (location.function.size) appendField(StaticString("function"), location.function);
+            if (location.file.size)     appendField(StaticString("file"),     location.file);
+            if (location.line)          appendField(StaticString("line"),     location.line);
+        }
+
+        template <typename T>
+        void appendMessage(const T& message) {
+            if (format_ == StructuredFormat::TEXT)
+                appendArgument(buffer_, message);
+            else
+                appendField(StaticString("message"), message);
+        }
+
+        template <typename T>
+        void appendField(StaticString key, const T& value) {
+            if (format_ == StructuredFormat::JSON) {
+                buffer_.append(isFirstField_ ? "\"" : ",\"");
+                appendArgument(buffer_, key);
+                buffer_.append("\":");
+            }
+            else {
+                if (!isFirstField_ || format_ == StructuredFormat::TEXT)
+                    buffer_.append(' ');
+                appendArgument(buffer_, key);
+                buffer_.append('=');
+            }
+            isFirstField_ = false;
+            appendValue(value);
+        }
+
+        void finish() {
+            if (format_ == StructuredFormat::JSON)
+                buffer_.append('}');
+        }
+
+    private:
+        template <typename T>
+        void appendValue(const T& value) {
+            using Type = std::decay_t<T>;
+
+            if constexpr (std::is_same_v<Type, bool>)
+                buffer_.append(value ? "true" : "false");
+            else if constexpr (std::is_same_v<Type, char> || std::is_same_v<Type, signed char> || std::is_same_v<Type, unsigned char>) {
+                const char character = static_cast<char>(value);
+                appendString(std::string_view(&character, 1));
+            }
+            else if constexpr (std::is_integral_v<Type>)
+                appendArgument(buffer_, value);
+            else if constexpr (std::is_floating_point_v<Type>) {
+                if (format_ == StructuredFormat::TEXT)
+                    appendArgument(buffer_, value);
+                else if (format_ == StructuredFormat::JSON && !std::isfinite(value))
+                    buffer_.append("null"); // JSON has no literal for them
+                else {
+                    // Shortest representation that reads back as the same value
+                    char* cursor = buffer_.reserve(64);
+                    #if defined(__cpp_lib_to_chars)
+                        buffer_.commit(std::to_chars(cursor, cursor + 64, value).ptr);
+                    #else
+                        buffer_.commit(cursor + std::snprintf(cursor, 64, "%.17g", static_cast<double>(value)));
+                    #endif
+                }
+            }
+            else if constexpr (std::is_same_v<Type, StaticString>)
+                appendString(std::string_view(value.data, value.size));
+            else if constexpr (std::is_pointer_v<T> && (std::is_same_v<Type, const char*> || std::is_same_v<Type, char*>))
+                appendString(value ? std::string_view(value) : std::string_view());
+            else if constexpr (std::is_convertible_v<const T&, std::string_view>)
+                appendString(std::string_view(value));
+            else {
+                // Rendered as in text lines, then escaped
+                FormatBuffer text;
+                appendArgument(text, value);
+                appendString(text.view());
+            }
+        }
+
+        // Quoted in JSON, and in logfmt only when needed
+        void appendString(std::string_view string) {
+            if (format_ == StructuredFormat::JSON) {
+                buffer_.append('"');
+                appendEscaped<false>(buffer_, string);
+                buffer_.append('"');
+            }
+            else if (!string.empty() && findSpecialCharacter<true>(string.data(), string.data() + string.size()) == string.data() + string.size())
+                buffer_.append(string);
+            else {
+                buffer_.append('"');
+                appendEscaped<true>(buffer_, string);
+                buffer_.append('"');
+            }
+        }
+
+        FormatBuffer&          buffer_;
+        const StructuredFormat format_;
+        bool                   isFirstField_ = true;
+    };
+
+    /*
+     * @brief Appends the level, the time and the elapsed time of a structured
+     *        record, as the first fields of its line.
+     */
+    inline void appendStructuredHeader(FormatBuffer& buffer, StructuredFormat format, LogLevel logLevel,
+                                       std::chrono::system_clock::time_point time, int64_t elapsed, TimestampPrecision precision) {
+        char        timestamp[48];
+        const char* end = writeUtcTimestamp(timestamp, time, precision);
+        const std::string_view timestampView(timestamp, static_cast<size_t>(end - timestamp));
+
+        if (format == StructuredFormat::JSON) {
+            buffer.append("{\"time\":\"");
+            buffer.append(timestampView);
+            buffer.append("\",\"level\":\"");
+            buffer.append(levelName(logLevel));
+            buffer.append("\",\"elapsed_us\":");
+            appendArgument(buffer, elapsed);
+            buffer.append(',');
+        }
+        else {
+            buffer.append("time=");
+            buffer.append(timestampView);
+            buffer.append(" level=");
+            buffer.append(levelName(logLevel));
+            buffer.append(" elapsed_us=");
+            appendArgument(buffer, elapsed);
+            buffer.append(' ');
+        }
+    }
+
+    /*
+     * @brief Message and fields of a structured record, as a single argument
+     *        of the log functions. The layout is read when the record is
+     *        created, so that a deferred record is rendered with it.
+     */
+    template <typename Message, typename... Values>
+    struct StructuredMessage {
+        StructuredFormat                  format;
+        SourceLocation                    location;
+        FormatStorage<Message>            message;
+        std::tuple<KeyValue<Values>...>   fields;
+    };
+
+    template <typename Message, typename... Values>
+    INLINING_TINYLOGGER void appendArgument(FormatBuffer& buffer, const StructuredMessage<Message, Values...>& message) {
+        StructuredWriter writer(buffer, message.format);
+        writer.appendLocation(message.location);
+        writer.appendMessage(message.message);
+        std::apply([&writer](const auto&... fields) { (writer.appendField(fields.key, fields.value), ...); }, message.fields);
+        writer.finish();
+    }
+
+    // Layout of the line the arguments are written in, TEXT unless structured
+    template <typename... Args>
+    StructuredFormat structuredFormatOf(const Args&...) {
+        return StructuredFormat::TEXT;
+    }
+
+    template <typename Message, typename... Values>
+    StructuredFormat structuredFormatOf(const StructuredMessage<Message, Values...>& message) {
+        return message.format;
+    }
+
+    // Argument as written in the binary log, the fields of records as text
+    template <typename T>
+    const T& binaryArgument(const T& argument) {
+        return argument;
+    }
+
+    template <typename Message, typename... Values>
+    StructuredMessage<Message, Values...> binaryArgument(const StructuredMessage<Message, Values...>& message) {
+        StructuredMessage<Message, Values...> text = message;
+        text.format = StructuredFormat::TEXT;
+        return text;
+    }
+
+    /*
+     * @brief Deferred structured records store their layout and location,
+     *        then the message and every (key, value) pair. The binary log
+     *        gets the fields rendered as a single text argument.
+     */
+    template <typename Message, typename... Values>
+    struct ArgCodec<StructuredMessage<Message, Values...>> {
+        using Structured = StructuredMessage<Message, Values...>;
+
+        static constexpr bool isDeferrable = areDeferrable<Message, Values...>;
+
+        struct Prefix {
+            StructuredFormat format;
+            SourceLocation   location;
+        };
+
+        static bool encode(char*& cursor, const char* end, const Structured& message) {
+            if (static_cast<size_t>(end - cursor) < sizeof(Prefix))
+                return false;
+            const Prefix prefix{ message.format, message.location };
+            std::memcpy(cursor, &prefix, sizeof(Prefix));
+            cursor += sizeof(Prefix);
+
+            return ArgCodec<Message>::encode(cursor, end, message.message)
+                && std::apply([&cursor, end](const auto&... fields) {
+                       return ((ArgCodec<StaticString>::encode(cursor, end, fields.key) && ArgCodec<Values>::encode(cursor, end, fields.value)) && ...);
+                   }, message.fields);
+        }
+
+        static const char* decode(const char* cursor, FormatBuffer& buffer) {
+            return decodeAs(cursor, buffer, std::nullopt);
+        }
+
+        static const char* encodeBinary(const char* cursor, BinaryEncoder& encoder) {
+            FormatBuffer text;
+            cursor = decodeAs(cursor, text, StructuredFormat::TEXT);
+            encoder.writeString(text.view());
+            return cursor;
+        }
+
+    private:
+        static const char* decodeAs(const char* cursor, FormatBuffer& buffer, std::optional<StructuredFormat> format) {
+            Prefix prefix{ StructuredFormat::TEXT, SourceLocation{ StaticString(""), StaticString(""), 0 } };
+            std::memcpy(&prefix, cursor, sizeof(Prefix));
+            cursor += sizeof(Prefix);
+
+            StructuredWriter writer(buffer, format.value_or(prefix.format));
+            writer.appendLocation(prefix.location);
+            cursor = ArgCodec<Message>::visit(cursor, [&writer](const auto& value) { writer.appendMessage(value); });
+            ((cursor = decodeField<Values>(cursor, writer)), ...);
+            writer.finish();
+            return cursor;
+        }
+
+        template <typename T>
+        static const char* decodeField(const char* cursor, StructuredWriter& writer) {
+            StaticString key("");
+            cursor = ArgCodec<StaticString>::visit(cursor, [&key](const StaticString& value) { key = value; });
+            return ArgCodec<T>::visit(cursor, [&writer, key](const auto& value) { writer.appendField(key, value); });
+        }
+    };
+
+    // Called by the LOG_<LEVEL>_KV macros, with the layout of the global logger
+    template <typename Message, typename... Values>
+    INLINING_TINYLOGGER StructuredMessage<std::decay_t<const Message&>, Values...> structuredMessage(
+            StructuredFormat format, const SourceLocation& location, const Message& message, const KeyValue<Values>&... fields) {
+        return StructuredMessage<std::decay_t<const Message&>, Values...>{ format, location, message, std::tuple<KeyValue<Values>...>(fields...) };
+    }
+
+    /*
+     * @brief Type-erased functions of the arguments of a record, one instance
+     *        per argument types sequence. They are all the templated front-ends
+     *        of Logger instantiate, the backend being a single function.
+     */
+    struct PackFormat {
+        const PayloadFormat* payloadFormat; // Null if the arguments cannot be deferred
+        StructuredFormat (*layout)      (const void* arguments);
+        bool             (*encode)      (const void* arguments, char*& cursor, const char* end);
+        void             (*append)      (const void* arguments, FormatBuffer& buffer);
+        void             (*appendBinary)(const void* arguments, FormatBuffer& buffer);
+    };
+
+    /*
+     * Arguments as stored by a pack, decayed as appendArgument renders them,
+     * so that string literals of any length share their functions. Scalars
+     * are copied, the other arguments referenced.
+     */
+    template <typename T>
+    using ArgumentType = std::decay_t<T>;
+
+    template <typename T>
+    using ArgumentElement = std::conditional_t<std::is_scalar_v<T>, T, const T&>;
+
+    template <typename... Args>
+    using ArgumentTuple = std::tuple<ArgumentElement<ArgumentType<Args>>...>;
+
+    template <typename... Args>
+    const std::tuple<ArgumentElement<Args>...>& packedArguments(const void* arguments) {
+        return *static_cast<const std::tuple<ArgumentElement<Args>...>*>(arguments);
+    }
+
+    template <typename... Args>
+    StructuredFormat packLayout(const void* arguments) {
+        return std::apply([](const auto&... args) { return structuredFormatOf(args...); }, packedArguments<Args...>(arguments));
+    }
+
+    template <typename... Args>
+    bool encodePack(const void* arguments, char*& cursor, const char* end) {
+        if constexpr (areDeferrable<Args...>)
+            return std::apply([&cursor, end](const auto&... args) { return encodeArguments(cursor, end, args...); }, packedArguments<Args...>(arguments));
+        else {
+            (void)arguments, (void)cursor, (void)end;
+            return false;
+        }
+    }
+
+    template <typename... Args>
+    void appendPack(const void* arguments, FormatBuffer& buffer) {
+        std::apply([&buffer](const auto&... args) { (appendArgument(buffer, args), ...); }, packedArguments<Args...>(arguments));
+    }
+
+    template <typename... Args>
+    void appendBinaryPack(const void* arguments, FormatBuffer& buffer) {
+        std::apply([&buffer](const auto&... args) { (appendArgument(buffer, binaryArgument(args)), ...); }, packedArguments<Args...>(arguments));
+    }
+
+    template <typename... Args>
+    constexpr const PayloadFormat* payloadFormatOf() {
+        if constexpr (areDeferrable<Args...>)
+            return &payloadFormat<std::decay_t<Args>...>;
+        else
+            return nullptr;
+    }
+
+    template <typename... Args>
+    inline constexpr PackFormat packFormat = { payloadFormatOf<Args...>(), &packLayout<Args...>, &encodePack<Args...>, &appendPack<Args...>, &appendBinaryPack<Args...> };
+
+    // Arguments referenced by a record until it is stored, see PackFormat
+    struct ArgumentPack {
+        const void*       arguments; // ArgumentTuple of the arguments
+        const PackFormat* format;
+    };
+
+    template <typename... Args>
+    INLINING_TINYLOGGER ArgumentPack packArguments(const ArgumentTuple<Args...>& arguments) {
+        return ArgumentPack{ &arguments, &packFormat<ArgumentType<Args>...> };
+    }
+
+} // namespace detail
+
+    /*
+     * @brief Field of a structured record, see the LOG_<LEVEL>_KV macros. The
+     *        value is referenced, and must outlive the log statement.
+     *
+     * @param key   String literal naming the field, written without escapes.
+     * @param value Boolean, number, string, or any streamable value.
+     */
+    template <size_t N, typename T>
+    INLINING_TINYLOGGER detail::KeyValue<std::decay_t<const T&>> kv(const char (&key)[N], const T& value) {
+        return detail::KeyValue<std::decay_t<const T&>>{ StaticString(key), value };
+    }
+
+    /*
+     * @brief Unformatted record given to binary sinks. When format is null,
+     *        the arguments could not be deferred and message holds the text.
+     */
+    struct RecordView {
+        const CallSite*                       callSite;
+        std::chrono::system_clock::time_point time;
+        const detail::PayloadFormat*          format;
+        const char*                           payload;
+        std::string_view                      message;
+    };
+
+    /*
+     * @brief Counters of a sink, see Logger::stats. Records and bytes are the
+     *        ones handed by the logger, the other fields are only known by
+     *        some sinks, and zero otherwise.
+     */
+    struct SinkStats {
+        std::string name;
+        uint64_t    records = 0;
+        uint64_t    bytes   = 0; // Of the text lines
+        uint64_t    dropped = 0; // Lines the sink discarded, see BackgroundSink
+        uint64_t    writes  = 0; // System calls the lines were written with
+
+        // Lines per system call, zero when the sink does not count its writes
+        double batchingFactor() const {
+            return writes ? static_cast<double>(records) / static_cast<double>(writes) : 0.0;
+        }
+    };
+
+    /*
+     * @brief Destination of the formatted lines. A line is formatted once by
+     *        the Logger, then handed to every sink whose level accepts it.
+     *
+     * Implementations must be thread-safe, since a sink may be shared by
+     * several loggers, and flushed by any thread.
+     */
+    class Sink {
+    public:
+        virtual ~Sink() = default;
+
+        // Writes a full line, ending with a new line character
+        virtual void write(LogLevel logLevel, std::string_view line) = 0;
+
+        // Binary sinks are given unformatted records through writeRecord
+        virtual bool isBinary() const { return false; }
+        virtual void writeRecord(const RecordView&) {}
+
+        // Called after a batch of lines, which is a single line when synchronous
+        virtual void endBatch() {}
+
+        // Called periodically by the asynchronous backend when it is idle
+        virtual void poll() {}
+
+        // Writes any buffered line to the destination
+        virtual void flush() {}
+
+        // Flushes, and waits for the lines to be durably stored if it applies
+        virtual void sync() { flush(); }
+
+        /*
+         * Used by the crash handler, see tl::installCrashHandler: crashFlush
+         * writes the buffered lines, then crashWrite is called for every line
+         * recovered from the asynchronous queue. Other threads may be stopped
+         * anywhere, so both must not lock nor allocate, and only use write(2)
+         * or memory they already own.
+         * By default, nothing is written.
+         */
+        virtual void crashFlush() {}
+        virtual void crashWrite(LogLevel, std::string_view) {}
+
+        // Names the sink, and fills the counters it keeps, see Logger::stats
+        virtual void describeStats(SinkStats& stats) const { stats.name = "sink"; }
+
+        // Counted by the logger when it hands a line or a record to the sink
+        void countWrite(size_t bytes) {
+            writtenRecords_.fetch_add(1,     std::memory_order_relaxed);
+            writtenBytes_  .fetch_add(bytes, std::memory_order_relaxed);
+        }
+
+        uint64_t writtenRecords() const { return writtenRecords_.load(std::memory_order_relaxed); }
+        uint64_t writtenBytes()   const { return writtenBytes_  .load(std::memory_order_relaxed); }
+
+        // Only lines at this level, or more severe, are given to this sink
+        void setLogLevel(LogLevel logLevel) {
+            logLevel_.store(logLevel, std::memory_order_relaxed);
+        }
+
+        bool accepts(LogLevel logLevel) const {
+            return logLevel <= logLevel_.load(std::memory_order_relaxed);
+        }
+
+    private:
+        std::atomic<LogLevel> logLevel_{ LogLevel::TRACE };
+        std::atomic<uint64_t> writtenRecords_{ 0 };
+        std::atomic<uint64_t> writtenBytes_{ 0 };
+    };
+
+    /*
+     * @brief Default sink, that writes INFO lines to std::cout, ERROR and
+     *        CRITICAL lines to std::cerr, and other lines to std::clog.
+     *
+     * Consecutive lines going to the same stream are gathered, and written
+     * at once at the end of every batch, so with a single system call per
+     * batch of the asynchronous backend. A line going to another stream, or
+     * not fitting in the buffer, first writes the gathered ones, so that the
+     * relative order of the lines is kept. Lines are written to the file
+     * descriptor of the stream, after flushing it, unless its buffer was
+     * replaced with rdbuf, in which case they go through the stream.
+     */
+    class ConsoleSink : public Sink {
+    public:
+        ConsoleSink() : streamBuffers_{ std::cout.rdbuf(), std::clog.rdbuf(), std::cerr.rdbuf() } {
+            pending_.reserve(bufferSize);
+        }
+
+        ~ConsoleSink() override {
+            flush();
+        }
+
+        void write(LogLevel logLevel, std::string_view line) override {
+            std::lock_guard<std::mutex> guard(mutex_);
+
+            const int stream = streamOf(logLevel);
+            if (stream != pendingStream_ || pending_.size() + line.size() > bufferSize)
+                writePending();
+            pendingStream_ = stream;
+
+            if (line.size() > bufferSize)
+                writeOut(stream, line);
+            else
+                pending_.append(line);
+            writtenLines_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        void endBatch() override {
+            std::lock_guard<std::mutex> guard(mutex_);
+            writePending();
+        }
+
+        void flush() override {
+            std::lock_guard<std::mutex> guard(mutex_);
+            writePending();
+            std::cout.flush();
+            std::clog.flush();
+            std::cerr.flush();
+        }
+
+        // Without the lock, and without the streams, that are not safe
+        void crashFlush() override {
+            detail::writeDescriptor(descriptorOf(pendingStream_), pending_.data(), pending_.size());
+            pending_.clear();
+        }
+
+        void crashWrite(LogLevel logLevel, std::string_view line) override {
+            detail::writeDescriptor(descriptorOf(streamOf(logLevel)), line.data(), line.size());
+        }
+
+        // Lines written, and writes they took: their ratio is the batching factor
+        size_t writtenLines() const {
+            return writtenLines_.load(std::memory_order_relaxed);
+        }
+
+        size_t writeCalls() const {
+            return writeCalls_.load(std::memory_order_relaxed);
+        }
+
+        void describeStats(SinkStats& stats) const override {
+            stats.name   = "console";
+            stats.writes = writeCalls();
+        }
+
+    private:
+        // Bytes gathered before they are written, even in the middle of a batch
+        static constexpr size_t bufferSize = 1 << 16;
+
+        static int streamOf(LogLevel logLevel) {
+            switch (logLevel) {
+                case LogLevel::INFO:
+                    return 0;
+                case LogLevel::LERROR:
+                case LogLevel::CRITICAL:
+                    return 2;
+                default:
+                    return 1;
+            }
+        }
+
+        static std::ostream& standardStream(int stream) {
+            return stream == 0 ? std::cout : stream == 1 ? std::clog : std::cerr;
+        }
+
+        static int descriptorOf(int stream) {
+            return stream == 0 ? 1 : 2;
+        }
+
+        void writePending() {
+            if (pending_.empty())
+                return;
+            writeOut(pendingStream_, pending_);
+            pending_.clear();
+        }
+
+        void writeOut(int stream, std::string_view data) {
+            std::ostream& standard = standardStream(stream);
+            if (standard.rdbuf() != streamBuffers_[stream]) {
+                standard.write(data.data(), static_cast<std::streamsize>(data.size()));
+                standard.flush();
+            }
+            else {
+                // What the program wrote to the stream comes first
+                standard.flush();
+                std::fflush(stream == 0 ? stdout : stderr);
+                detail::writeDescriptor(descriptorOf(stream), data.data(), data.size());
+            }
+            writeCalls_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        std::streambuf* const streamBuffers_[3];
+        std::string           pending_;
+        int                   pendingStream_ = 0;
+        std::mutex            mutex_;
+
+        std::atomic<size_t> writtenLines_{ 0 };
+        std::atomic<size_t> writeCalls_{ 0 };
+    };
+
+    /*
+     * @brief Keeps the last lines in memory, for example to be displayed by
+     *        a diagnostic endpoint. Slots are reused, so that a steady state
+     *        does not allocate.
+     */
+    class MemorySink : public Sink {
+    public:
+        explicit MemorySink(size_t capacity) : lines_(std::max<size_t>(capacity, 1)) {}
+
+        void write(LogLevel, std::string_view line) override {
+            std::lock_guard<std::mutex> guard(mutex_);
+            lines_[next_ % lines_.size()].assign(line.data(), line.size());
+            ++next_;
+        }
+
+        // Returns the kept lines, from the oldest to the most recent one
+        std::vector<std::string> lines() const {
+            std::lock_guard<std::mutex> guard(mutex_);
+
+            const size_t count = std::min(next_, lines_.size());
+            std::vector<std::string> result;
+            result.reserve(count);
+            for (size_t i = next_ - count; i < next_; ++i)
+                result.push_back(lines_[i % lines_.size()]);
+            return result;
+        }
+
+        void describeStats(SinkStats& stats) const override {
+            stats.name = "memory";
+        }
+
+    private:
+        std::vector<std::string> lines_;
+        size_t                   next_ = 0;
+        mutable std::mutex       mutex_;
+    };
+
+    /*
+     * @brief Decouples a slow sink from the others: lines are copied into a
+     *        bounded queue, and written to the wrapped sink by a dedicated
+     *        thread. Lines are dropped, and counted, when the queue is full.
+     */
+    class BackgroundSink : public Sink {
+    public:
+        explicit BackgroundSink(std::shared_ptr<Sink> sink, size_t queueCapacity = 8192)
+            : sink_(std::move(sink)), queue_(queueCapacity) {
+            thread_ = std::thread(&BackgroundSink::run, this);
+        }
+
+        ~BackgroundSink() override {
+            running_.store(false, std::memory_order_release);
+            thread_.join();
+        }
+
+        void write(LogLevel logLevel, std::string_view line) override {
+            if (queue_.tryPush(Line{ logLevel, std::string(line) }))
+                pushedLines_.fetch_add(1, std::memory_order_release);
+            else
+                droppedLines_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // Waits for the queued lines to be written, then flushes the sink
+        void flush() override {
+            const size_t target = pushedLines_.load(std::memory_order_acquire);
+            while (writtenLines_.load(std::memory_order_acquire) < target)
+                std::this_thread::yield();
+            sink_->flush();
+        }
+
+        void sync() override {
+            flush();
+            sink_->sync();
+        }
+
+        // The queued lines are visited in place, since popping them would free memory
+        void crashFlush() override {
+            sink_->crashFlush();
+            while (queue_.tryVisit([this](const Line& line) { sink_->crashWrite(line.logLevel, line.text); }))
+                continue;
+        }
+
+        void crashWrite(LogLevel logLevel, std::string_view line) override {
+            sink_->crashWrite(logLevel, line);
+        }
+
+        size_t droppedLines() const {
+            return droppedLines_.load(std::memory_order_relaxed);
+        }
+
+        // The records and bytes are the ones of the background sink
+        void describeStats(SinkStats& stats) const override {
+            SinkStats inner;
+            sink_->describeStats(inner);
+            stats.name    = "background:" + inner.name;
+            stats.dropped = droppedLines();
+            stats.writes  = inner.writes;
+        }
+
+    private:
+        struct Line {
+            LogLevel    logLevel = LogLevel::OFF;
+            std::string text;
+        };
+
+        void run() {
+            Line line;
+            for (;;) {
+                const bool isRunning = running_.load(std::memory_order_acquire);
+
+                size_t batchSize = 0;
+                while (queue_.tryPop(line)) {
+                    sink_->write(line.logLevel, line.text);
+                    ++batchSize;
+                }
+
+                if (batchSize > 0) {
+                    sink_->endBatch();
+                    writtenLines_.fetch_add(batchSize, std::memory_order_release);
+                    continue;
+                }
+
+                if (!isRunning)
+                    return;
+
+                sink_->poll();
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+        }
+
+        std::shared_ptr<Sink>          sink_;
+        detail::BoundedQueue<Line>     queue_;
+        std::atomic<bool>              running_{ true };
+        std::atomic<size_t>            pushedLines_{ 0 };
+        std::atomic<size_t>            writtenLines_{ 0 };
+        std::atomic<size_t>            droppedLines_{ 0 };
+        std::thread                    thread_;
+    };
+
+#if defined(__unix__) || defined(__APPLE__)
+} // namespace tl
+
+// Declared here rather than including <syslog.h>, which defines LOG_INFO,
+// LOG_DEBUG and LOG_WARNING macros and would conflict with the logger ones
+extern "C" {
+    void openlog(const char* ident, int option, int facility);
+    void syslog(int priority, const char* format, ...);
+    void closelog(void);
+}
+
+namespace tl {
+
+    /*
+     * @brief Sends lines to the system logger. The header with the level and
+     *        the time is kept, since it carries the elapsed time.
+     *
+     * @note Only one identity can be registered by process, closing the sink
+     *       closes the connection for every syslog user of the process.
+     */
+    class SyslogSink : public Sink {
+    public:
+        explicit SyslogSink(const char* identity = nullptr) {
+            openlog(identity, syslogPid, syslogUserFacility);
+        }
+
+        ~SyslogSink() override {
+            closelog();
+        }
+
+        void write(LogLevel logLevel, std::string_view line) override {
+            if (!line.empty() && line.back() == '\n')
+                line.remove_suffix(1);
+            syslog(priority(logLevel), "%.*s", static_cast<int>(line.size()), line.data());
+        }
+
+        void describeStats(SinkStats& stats) const override {
+            stats.name = "syslog";
+        }
+
+    private:
+        // Values of LOG_PID and LOG_USER, identical on every POSIX system
+        static constexpr int syslogPid          = 0x01;
+        static constexpr int syslogUserFacility = 1 << 3;
+
+        static int priority(LogLevel logLevel) {
+            switch (logLevel) {
+                case LogLevel::CRITICAL: return 2; // LOG_CRIT
+                case LogLevel::LERROR:   return 3; // LOG_ERR
+                case LogLevel::WARNING:  return 4; // LOG_WARNING
+                case LogLevel::INFO:     return 6; // LOG_INFO
+                default:                 return 7; // LOG_DEBUG
+            }
+        }
+    };
+#endif
+
+    /*
+     * @brief Options of a FileSink.
+     *
+     * @param bufferSize    Bytes kept in memory before they are written.
+     * @param flushInterval Maximum age of buffered lines, zero disables it.
+     * @param flushLevel    Lines at this level, or more severe, are written
+     *                      to the file right away.
+     */
+    struct FileSinkOptions {
+        size_t                    bufferSize    = 1 << 20;
+        std::chrono::milliseconds flushInterval = std::chrono::milliseconds(1000);
+        LogLevel                  flushLevel    = LogLevel::LERROR;
+    };
+
+    /*
+     * @brief Appends lines to a file through a large user-space buffer, so
+     *        that many lines are written with a single system call.
+     *
+     * The buffer is written when it is full, when a line is at least as
+     * severe as flushLevel, or when the oldest buffered line is older than
+     * flushInterval. The interval is checked on every write, and also when
+     * the asynchronous backend is idle.
+     */
+    class FileSink : public Sink {
+    public:
+        explicit FileSink(const std::filesystem::path& path, const FileSinkOptions& options = FileSinkOptions())
+            : options_(options), buffer_(std::max<size_t>(options.bufferSize, 1)) {
+            #ifdef _WIN32
+                descriptor_ = _wopen(path.c_str(), _O_WRONLY | _O_CREAT | _O_APPEND | _O_BINARY, _S_IREAD | _S_IWRITE);
+            #else
+                descriptor_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+            #endif
+            lastFlush_ = std::chrono::steady_clock::now();
+        }
+
+        ~FileSink() override {
+            flush();
+            #ifdef _WIN32
+                if (descriptor_ >= 0) _close(descriptor_);
+            #else
+                if (descriptor_ >= 0) ::close(descriptor_);
+            #endif
+        }
+
+        FileSink(const FileSink&)            = delete;
+        FileSink& operator=(const FileSink&) = delete;
+
+        bool isOpen() const {
+            return descriptor_ >= 0;
+        }
+
+        void write(LogLevel logLevel, std::string_view line) override {
+            std::lock_guard<std::mutex> guard(mutex_);
+
+            if (line.size() > buffer_.size() - size_)
+                writeBuffer();
+
+            // Lines larger than the whole buffer are written directly
+            if (line.size() > buffer_.size())
+                writeAll(line.data(), line.size());
+            else {
+                std::memcpy(buffer_.data() + size_, line.data(), line.size());
+                size_ += line.size();
+            }
+
+            if (logLevel <= options_.flushLevel || isFlushDue())
+                writeBuffer();
+        }
+
+        // Writes the buffered lines to the file, if the interval has elapsed
+        void poll() override {
+            std::lock_guard<std::mutex> guard(mutex_);
+            if (size_ > 0 && isFlushDue())
+                writeBuffer();
+        }
+
+        // Writes the buffered lines to the file
+        void flush() override {
+            std::lock_guard<std::mutex> guard(mutex_);
+            writeBuffer();
+        }
+
+        // Writes the buffered lines, and waits for them to reach the disk
+        void sync() override {
+            std::lock_guard<std::mutex> guard(mutex_);
+            writeBuffer();
+            #ifdef _WIN32
+                if (descriptor_ >= 0) _commit(descriptor_);
+            #else
+                if (descriptor_ >= 0) ::fsync(descriptor_);
+            #endif
+        }
+
+        // Without the lock, which the crashed thread may hold
+        void crashFlush() override {
+            detail::writeDescriptor(descriptor_, buffer_.data(), size_);
+            size_ = 0;
+        }
+
+        void crashWrite(LogLevel, std::string_view line) override {
+            detail::writeDescriptor(descriptor_, line.data(), line.size());
+        }
+
+        void describeStats(SinkStats& stats) const override {
+            stats.name   = "file";
+            stats.writes = writeCalls_.load(std::memory_order_relaxed);
+        }
+
+    private:
+        bool isFlushDue() const {
+            return options_.flushInterval.count() > 0 &&
+                   std::chrono::steady_clock::now() - lastFlush_ >= options_.flushInterval;
+        }
+
+        void writeBuffer() {
+            if (size_ > 0)
+                writeAll(buffer_.data(), size_);
+            size_      = 0;
+            lastFlush_ = std::chrono::steady_clock::now();
+        }
+
+        void writeAll(const char* data, size_t size) {
+            detail::writeDescriptor(descriptor_, data, size);
+            writeCalls_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        FileSinkOptions                       options_;
+        int                                   descriptor_ = -1;
+        std::vector<char>                     buffer_;
+        size_t                                size_       = 0;
+        std::chrono::steady_clock::time_point lastFlush_;
+        std::mutex                            mutex_;
+        std::atomic<uint64_t>                 writeCalls_{ 0 };
+    };
+
+    /*
+     * @brief Options of a RotatingFileSink.
+     *
+     * @param file             Buffering and flush policy of every segment.
+     * @param maxFileSize      Bytes after which a segment is closed, zero
+     *                         disables size-based rotation.
+     * @param rotationInterval Wall-clock period of the segments, aligned on
+     *                         multiples of it since epoch (an hour rotates at
+     *                         every hh:00). Zero disables time-based rotation.
+     * @param maxFiles         Number of closed segments kept, zero keeps all.
+     * @param compressCommand  Command run on every closed segment with its
+     *                         path as last argument, as "gzip -f" or "zstd -q
+     *                         --rm". Empty disables compression.
+     */
+    struct RotatingFileSinkOptions {
+        FileSinkOptions      file;
+        size_t               maxFileSize      = 64 << 20;
+        std::chrono::seconds rotationInterval = std::chrono::seconds(0);
+        size_t               maxFiles         = 10;
+        std::string          compressCommand;
+    };
+
+    /*
+     * @brief File sink that rolls to a new segment by size or by time.
+     *
+     * For a base path 'logs/app.log', segments are named after their opening
+     * time, as 'logs/app.20261014-081033.000001.log', so that they never have
+     * to be renamed. A maintenance thread opens the next segment in advance,
+     * and closes, compresses and deletes the old ones: a logging thread only
+     * swaps two pointers when a segment is full, and only opens the next one
+     * itself when the thread is late, so that segments never exceed their size.
+     */
+    class RotatingFileSink : public Sink {
+    public:
+        explicit RotatingFileSink(const std::filesystem::path& basePath,
+                                  const RotatingFileSinkOptions& options = RotatingFileSinkOptions())
+            : basePath_(basePath), options_(options) {
+            current_          = openSegment(currentPath_);
+            nextRotationTime_ = computeNextRotationTime();
+            thread_           = std::thread(&RotatingFileSink::maintain, this);
+        }
+
+        ~RotatingFileSink() override {
+            {
+                std::lock_guard<std::mutex> guard(mutex_);
+                running_ = false;
+            }
+            condition_.notify_one();
+            thread_.join();
+
+            // The segment opened in advance was never used
+            if (next_) {
+                next_.reset();
+                std::error_code error;
+                std::filesystem::remove(nextPath_, error);
+            }
+        }
+
+        bool isOpen() const {
+            std::lock_guard<std::mutex> guard(mutex_);
+            return current_ && current_->isOpen();
+        }
+
+        // Path of the segment currently written
+        std::filesystem::path currentPath() const {
+            std::lock_guard<std::mutex> guard(mutex_);
+            return currentPath_;
+        }
+
+        void write(LogLevel logLevel, std::string_view line) override {
+            std::unique_lock<std::mutex> lock(mutex_);
+
+            const bool isFull = options_.maxFileSize > 0 && currentSize_ > 0 &&
+                                currentSize_ + line.size() > options_.maxFileSize;
+            if (isFull || isRotationTimeReached())
+                rotate(lock);
+
+            current_->write(logLevel, line);
+            currentSize_ += line.size();
+        }
+
+        void poll() override {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (isRotationTimeReached())
+                rotate(lock);
+            current_->poll();
+        }
+
+        void flush() override {
+            std::lock_guard<std::mutex> guard(mutex_);
+            current_->flush();
+        }
+
+        void sync() override {
+            std::lock_guard<std::mutex> guard(mutex_);
+            current_->sync();
+        }
+
+        void crashFlush() override {
+            if (FileSink* current = current_.get())
+                current->crashFlush();
+        }
+
+        void crashWrite(LogLevel logLevel, std::string_view line) override {
+            if (FileSink* current = current_.get())
+                current->crashWrite(logLevel, line);
+        }
+
+        void describeStats(SinkStats& stats) const override {
+            stats.name = "rotating_file";
+        }
+
+    private:
+        struct Segment {
+            std::unique_ptr<FileSink> sink;
+            std::filesystem::path     path;
+        };
+
+        bool isRotationTimeReached() const {
+            return options_.rotationInterval.count() > 0 && std::chrono::system_clock::now() >= nextRotationTime_;
+        }
+
+        std::chrono::system_clock::time_point computeNextRotationTime() const {
+            if (options_.rotationInterval.count() == 0)
+                return std::chrono::system_clock::time_point::max();
+
+            const auto sinceEpoch = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch());
+            return std::chrono::system_clock::time_point((sinceEpoch / options_.rotationInterval + 1) * options_.rotationInterval);
+        }
+
+        // Swaps in the segment prepared by the maintenance thread, waiting for it
+        // while it is being opened, and opening it here if the thread is busy
+        void rotate(std::unique_lock<std::mutex>& lock) {
+            handoff_.wait(lock, [this]() { return !isOpeningNext_; });
+            if (!next_)
+                next_ = openSegment(nextPath_);
+
+            retired_.push_back(Segment{ std::move(current_), currentPath_ });
+            current_          = std::move(next_);
+            currentPath_      = nextPath_;
+            currentSize_      = 0;
+            nextRotationTime_ = computeNextRotationTime();
+
+            lock.unlock();
+            condition_.notify_one();
+            lock.lock();
+        }
+
+        std::unique_ptr<FileSink> openSegment(std::filesystem::path& path) {
+            std::tm    local{};
+            const auto instant = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+            #ifdef _WIN32
+                localtime_s(&local, &instant);
+            #else
+                localtime_r(&instant, &local);
+            #endif
+
+            char name[32];
+            std::strftime(name, sizeof(name), "%Y%m%d-%H%M%S", &local);
+
+            char sequence[8];
+            detail::writeFixedDigits(sequence, ++segmentCount_ % 1000000, 6)[0] = '\0';
+
+            path = basePath_;
+            path.replace_filename(basePath_.stem().string() + "." + name + "." + sequence + basePath_.extension().string());
+            return std::make_unique<FileSink>(path, options_.file);
+        }
+
+        void maintain() {
+            std::unique_lock<std::mutex> lock(mutex_);
+            for (;;) {
+                condition_.wait(lock, [this]() { return !running_ || !next_ || !retired_.empty(); });
+
+                if (!next_ && running_) {
+                    isOpeningNext_ = true;
+                    lock.unlock();
+                    std::filesystem::path     path;
+                    std::unique_ptr<FileSink> segment = openSegment(path);
+                    lock.lock();
+
+                    next_          = std::move(segment);
+                    nextPath_      = path;
+                    isOpeningNext_ = false;
+                    handoff_.notify_all();
+                }
+
+                std::deque<Segment> retired;
+                retired.swap(retired_);
+
+                lock.unlock();
+                for (Segment& segment : retired) {
+                    segment.sink.reset(); // Writes the remaining lines and closes the file
+                    compress(segment.path);
+                }
+                if (!retired.empty())
+                    removeOldSegments();
+                lock.lock();
+
+                if (!running_ && retired_.empty())
+                    return;
+            }
+        }
+
+        void compress(const std::filesystem::path& path) const {
+            if (options_.compressCommand.empty())
+                return;
+
+            #ifdef _WIN32
+                const std::string command = options_.compressCommand + " \"" + path.string() + "\"";
+            #else
+                std::string quotedPath = "'";
+                for (char character : path.string())
+                    quotedPath += (character == '\'') ? std::string("'\\''") : std::string(1, character);
+                const std::string command = options_.compressCommand + " " + quotedPath + "'";
+            #endif
+            (void)std::system(command.c_str());
+        }
+
+        // Keeps the maxFiles most recent closed segments, oldest names first
+        void removeOldSegments() const {
+            if (options_.maxFiles == 0)
+                return;
+
+            const std::string prefix = basePath_.stem().string() + ".";
+            std::filesystem::path directory = basePath_.parent_path();
+            if (directory.empty())
+                directory = ".";
+
+            std::filesystem::path activePath, preparedPath;
+            {
+                std::lock_guard<std::mutex> guard(mutex_);
+                activePath   = currentPath_.filename();
+                preparedPath = nextPath_.filename();
+            }
+
+            std::vector<std::filesystem::path> segments;
+            std::error_code error;
+            for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+                const std::string name = entry.path().filename().string();
+                const bool isSegment   = name.size() > prefix.size() + 8 && name.compare(0, prefix.size(), prefix) == 0 &&
+                                         std::all_of(name.begin() + static_cast<ptrdiff_t>(prefix.size()),
+                                                     name.begin() + static_cast<ptrdiff_t>(prefix.size()) + 8,
+                                                     [](char character) { return character >= '0' && character <= '9'; });
+                if (isSegment && entry.path().filename() != activePath && entry.path().filename() != preparedPath)
+                    segments.push_back(entry.path());
+            }
+
+            std::sort(segments.begin(), segments.end());
+            for (size_t i = 0; i + options_.maxFiles < segments.size(); ++i)
+                std::filesystem::remove(segments[i], error);
+        }
+
+        const std::filesystem::path           basePath_;
+        const RotatingFileSinkOptions         options_;
+
+        std::unique_ptr<FileSink>             current_;
+        std::filesystem::path                 currentPath_;
+        size_t                                currentSize_ = 0;
+        std::chrono::system_clock::time_point nextRotationTime_;
+        size_t                                segmentCount_ = 0; // Only used by the thread opening a segment
+
+        // Shared with the maintenance thread, protected by mutex_
+        std::unique_ptr<FileSink>             next_;
+        std::filesystem::path                 nextPath_;
+        std::deque<Segment>                   retired_;
+        bool                                  running_       = true;
+        bool                                  isOpeningNext_ = false;
+
+        mutable std::mutex                    mutex_;
+        std::condition_variable               condition_;
+        std::condition_variable               handoff_; // Signals the segment opened by the maintenance thread
+        std::thread                           thread_;
+    };
+
+    /*
+     * @brief Options of a MappedFileSink.
+     *
+     * @param segmentSize   Bytes preallocated and mapped for every segment, at
+     *                      least one page of 4 KiB.
+     * @param retryInterval Time before a segment that could not be created,
+     *                      as the disk is full for instance, is tried again.
+     *                      Lines written meanwhile are dropped, and counted.
+     */
+    struct MappedFileSinkOptions {
+        size_t                    segmentSize   = 64 << 20;
+        std::chrono::milliseconds retryInterval = std::chrono::milliseconds(1000);
+    };
+
+    /*
+     * @brief Sink copying lines straight into a memory-mapped, preallocated
+     *        file. Writing a line is a single memcpy, without any stdio copy nor
+     *        system call. Lines are in the page cache as soon as written, so
+     *        they survive a crash of the process.
+     *
+     * For a base path 'logs/trace.log', segments are named 'logs/trace.000001
+     * .log', the first free index being used. When a segment is full, the
+     * next one is mapped. Closed segments are truncated to their content.
+     * A segment that cannot be created is removed, and isOpen() is false
+     * until it is created again, at most once every retryInterval.
+     */
+    class MappedFileSink : public Sink {
+    public:
+        explicit MappedFileSink(const std::filesystem::path& basePath,
+                                const MappedFileSinkOptions& options = MappedFileSinkOptions())
+            : basePath_(basePath), options_(validated(options)) {
+            openSegment(options_.segmentSize);
+        }
+
+        ~MappedFileSink() override {
+            closeSegment();
+        }
+
+        MappedFileSink(const MappedFileSink&)            = delete;
+        MappedFileSink& operator=(const MappedFileSink&) = delete;
+
+        bool isOpen() const {
+            std::lock_guard<std::mutex> guard(mutex_);
+            return mapping_ != nullptr;
+        }
+
+        // Path of the segment currently mapped, empty when none could be created
+        std::filesystem::path currentPath() const {
+            std::lock_guard<std::mutex> guard(mutex_);
+            return currentPath_;
+        }
+
+        void write(LogLevel, std::string_view line) override {
+            std::lock_guard<std::mutex> guard(mutex_);
+
+            if (line.size() > capacity_ - offset_) {
+                closeSegment();
+                if (!hasFailed_ || std::chrono::steady_clock::now() >= nextAttempt_)
+                    openSegment(std::max(options_.segmentSize, line.size()));
+            }
+            if (!mapping_) {
+                ++droppedLines_;
+                return;
+            }
+
+            std::memcpy(mapping_ + offset_, line.data(), line.size());
+            offset_ += line.size();
+        }
+
+        void describeStats(SinkStats& stats) const override {
+            std::lock_guard<std::mutex> guard(mutex_);
+            stats.name    = "mapped_file";
+            stats.dropped = droppedLines_;
+        }
+
+        // Waits for the written lines to reach the disk
+        void sync() override {
+            std::lock_guard<std::mutex> guard(mutex_);
+            if (!mapping_)
+                return;
+
+            #ifdef _WIN32
+                FlushViewOfFile(mapping_, offset_);
+                FlushFileBuffers(file_);
+            #else
+                ::msync(mapping_, capacity_, MS_SYNC);
+            #endif
+        }
+
+        // Nothing is buffered, the written lines already are in the page cache
+        void crashFlush() override {}
+
+        // Without the lock, and only in the mapped segment: mapping the next one allocates
+        void crashWrite(LogLevel, std::string_view line) override {
+            if (mapping_ && line.size() <= capacity_ - offset_) {
+                std::memcpy(mapping_ + offset_, line.data(), line.size());
+                offset_ += line.size();
+            }
+        }
+
+    private:
+        static constexpr size_t minimumSegmentSize = 4096;
+        static constexpr size_t maxSegmentIndex    = 1000000;
+
+        // Smaller segments would map a new file every few lines
+        static MappedFileSinkOptions validated(MappedFileSinkOptions options) {
+            options.segmentSize = std::max(options.segmentSize, minimumSegmentSize);
+            return options;
+        }
+
+        void openSegment(size_t size) {
+            // Gives up once every index was probed, as many segments already exist
+            std::error_code error;
+            size_t          probes = 0;
+            do {
+                if (probes++ == maxSegmentIndex) {
+                    failSegment();
+                    return;
+                }
+                char index[8];
+                detail::writeFixedDigits(index, ++segmentIndex_ % maxSegmentIndex, 6)[0] = '\0';
+                currentPath_ = basePath_;
+                currentPath_.replace_filename(basePath_.stem().string() + "." + index + basePath_.extension().string());
+            } while (std::filesystem::exists(currentPath_, error));
+
+            #ifdef _WIN32
+                file_ = CreateFileW(currentPath_.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ,
+                                    nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+                const bool isCreated = file_ != INVALID_HANDLE_VALUE;
+                if (isCreated) {
+                    const ULARGE_INTEGER mappingSize{ { static_cast<DWORD>(size), static_cast<DWORD>(static_cast<uint64_t>(size) >> 32) } };
+                    mappingHandle_ = CreateFileMappingW(file_, nullptr, PAGE_READWRITE, mappingSize.HighPart, mappingSize.LowPart, nullptr);
+                    if (mappingHandle_)
+                        mapping_ = static_cast<char*>(MapViewOfFile(mappingHandle_, FILE_MAP_WRITE, 0, 0, size));
+                }
+            #else
+                descriptor_ = ::open(currentPath_.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+                const bool isCreated = descriptor_ >= 0;
+                if (isCreated) {
+                    // Preallocation avoids a SIGBUS on a sparse file when disk is full
+                    #ifdef __linux__
+                        const bool isAllocated = ::posix_fallocate(descriptor_, 0, static_cast<off_t>(size)) == 0;
+                    #else
+                        const bool isAllocated = ::ftruncate(descriptor_, static_cast<off_t>(size)) == 0;
+                    #endif
+                    if (isAllocated) {
+                        void* mapping = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor_, 0);
+                        if (mapping != MAP_FAILED)
+                            mapping_ = static_cast<char*>(mapping);
+                    }
+                }
+            #endif
+
+            // The empty file is removed, and its index taken again by the next attempt
+            if (!mapping_) {
+                closeSegment();
+                if (isCreated)
+                    std::filesystem::remove(currentPath_, error);
+                --segmentIndex_;
+                failSegment();
+                return;
+            }
+
+            hasFailed_ = false;
+            capacity_  = size;
+            offset_    = 0;
+        }
+
+        // Lines are dropped until the next attempt, rather than creating a file per line
+        void failSegment() {
+            currentPath_.clear();
+            hasFailed_   = true;
+            nextAttempt_ = std::chrono::steady_clock::now() + options_.retryInterval;
+        }
+
+        void closeSegment() {
+            #ifdef _WIN32
+                if (mapping_)
+                    UnmapViewOfFile(mapping_);
+                if (mappingHandle_)
+                    CloseHandle(mappingHandle_);
+                if (file_ != INVALID_HANDLE_VALUE) {
+                    LARGE_INTEGER end;
+                    end.QuadPart = static_cast<LONGLONG>(offset_);
+                    SetFilePointerEx(file_, end, nullptr, FILE_BEGIN);
+                    SetEndOfFile(file_);
+                    CloseHandle(file_);
+                }
+                mappingHandle_ = nullptr;
+                file_          = INVALID_HANDLE_VALUE;
+            #else
+                if (mapping_)
+                    ::munmap(mapping_, capacity_);
+                if (descriptor_ >= 0) {
+                    (void)::ftruncate(descriptor_, static_cast<off_t>(offset_));
+                    ::close(descriptor_);
+                }
+                descriptor_ = -1;
+            #endif
+
+            mapping_  = nullptr;
+            capacity_ = 0;
+            offset_   = 0;
+        }
+
+        const std::filesystem::path           basePath_;
+        const MappedFileSinkOptions           options_;
+
+        std::filesystem::path                 currentPath_;
+        size_t                                segmentIndex_  = 0;
+        char*                                 mapping_       = nullptr;
+        size_t                                capacity_      = 0;
+        size_t                                offset_        = 0;
+        bool                                  hasFailed_     = false;
+        std::chrono::steady_clock::time_point nextAttempt_;
+        uint64_t                              droppedLines_  = 0;
+        #ifdef _WIN32
+            HANDLE                            file_          = INVALID_HANDLE_VALUE;
+            HANDLE                            mappingHandle_ = nullptr;
+        #else
+            int                               descriptor_    = -1;
+        #endif
+        mutable std::mutex                    mutex_;
+    };
+
+    /*
+     * @brief Writes records in the binary log format described above, through
+     *        a buffered FileSink. Nothing is rendered as text: the records can
+     *        be turned back into lines offline with tinylogger_decode.
+     */
+    class BinaryFileSink : public Sink {
+    public:
+        explicit BinaryFileSink(const std::filesystem::path& path, const FileSinkOptions& options = FileSinkOptions())
+            : file_(path, options) {
+            file_.write(LogLevel::TRACE, std::string_view(binary::sessionTag, sizeof(binary::sessionTag) - 1));
+        }
+
+        bool isOpen() const {
+            return file_.isOpen();
+        }
+
+        bool isBinary() const override { return true; }
+
+        void write(LogLevel, std::string_view) override {}
+
+        void writeRecord(const RecordView& record) override {
+            std::lock_guard<std::mutex> guard(mutex_);
+            definitions_.clear();
+            record_.clear();
+
+            const CallSite& callSite = *record.callSite;
+            if (callSite.id >= knownCallSites_.size())
+                knownCallSites_.resize(callSite.id + 1, false);
+            if (!knownCallSites_[callSite.id]) {
+                knownCallSites_[callSite.id] = true;
+                definitions_.push_back(binary::callSiteTag);
+                binary::writeVarint(definitions_, callSite.id);
+                definitions_.push_back(static_cast<char>(callSite.logLevel));
+            }
+
+            const int64_t microseconds = std::chrono::duration_cast<std::chrono::microseconds>(record.time.time_since_epoch()).count();
+            record_.push_back(binary::recordTag);
+            binary::writeVarint(record_, callSite.id);
+            binary::writeFixed(record_, static_cast<uint64_t>(microseconds), 8);
+
+            BinaryEncoder encoder(definitions_, record_, strings_);
+            if (record.format) {
+                binary::writeVarint(record_, record.format->argumentCount);
+                record.format->encodeBinary(record.payload, encoder);
+            }
+            else {
+                binary::writeVarint(record_, 1);
+                encoder.writeString(record.message);
+            }
+
+            definitions_ += record_;
+            file_.write(callSite.logLevel, definitions_);
+        }
+
+        void poll()  override { file_.poll();  }
+        void flush() override { file_.flush(); }
+        void sync()  override { file_.sync();  }
+
+        // Records recovered from the queue are text lines, and so not written
+        void crashFlush() override { file_.crashFlush(); }
+
+        void describeStats(SinkStats& stats) const override {
+            file_.describeStats(stats);
+            stats.name = "binary_file";
+        }
+
+    private:
+        FileSink                                  file_;
+        std::string                               definitions_;
+        std::string                               record_;
+        std::unordered_map<const char*, uint32_t> strings_;
+        std::vector<bool>                         knownCallSites_;
+        std::mutex                                mutex_;
+    };
+
+    /*
+     * @brief Named subset of the logging statements, with its own level, as
+     *        returned by Logger::category or TL_CATEGORY. The records of all
+     *        the categories go through their logger, and share its backend.
+     *
+     *        A category writes to the sinks of its logger, until a sink is
+     *        added to it with Logger::addSink(category, sink): it then only
+     *        writes to its own sinks.
+     */
+    class Category {
+    public:
+        Category(std::string name, LogLevel logLevel) : name_(std::move(name)), logLevel_(logLevel) {}
+
+        const std::string& name() const {
+            return name_;
+        }
+
+        LogLevel logLevel() const {
+            return logLevel_.load(std::memory_order_relaxed);
+        }
+
+        // Changes the level of this category only, see Logger::setLogLevel
+        void setLogLevel(LogLevel logLevel) {
+            logLevel_.store(logLevel, std::memory_order_relaxed);
+            detail::levelGeneration.fetch_add(1, std::memory_order_release);
+        }
+
+    private:
+        friend struct ::Logger;
+
+        const std::string     name_;
+        std::atomic<LogLevel> logLevel_;
+
+        // Protected by the mutex of the logger, as the sinks of the logger
+        bool                               hasOwnSinks_ = false;
+        std::vector<std::shared_ptr<Sink>> sinks_;
+
+        // Read without lock by the producers, see Logger::sinkKindsOf
+        std::atomic<unsigned> sinkKinds_{ 0 };
+
+        // Tick of the previous record, with ElapsedScope::CATEGORY
+        mutable std::atomic<uint64_t> lastLogTime_{ 0 };
+    };
+
+namespace detail {
+
+    /*
+     * @brief Log-linear histogram of durations in nanoseconds, in the manner
+     *        of HDR histograms: every power of two is split in subBucketCount
+     *        buckets, so that values are kept with a relative error below 7%.
+     *        Written by a single thread, and read by reportTimers.
+     */
+    class TimerHistogram {
+    public:
+        static constexpr int    subBucketBits  = 4;
+        static constexpr size_t subBucketCount = size_t(1) << subBucketBits;
+        static constexpr int    maxExponent    = 44; // About 4.9 hours
+        static constexpr size_t bucketCount    = (maxExponent - subBucketBits + 1) * subBucketCount;
+
+        using Counts = std::array<uint64_t, bucketCount>;
+
+        static size_t bucketOf(uint64_t nanoseconds) {
+            if (nanoseconds < subBucketCount)
+                return static_cast<size_t>(nanoseconds);
+
+            int exponent = 63;
+            while (!(nanoseconds >> exponent))
+                --exponent;
+            if (exponent >= maxExponent)
+                return bucketCount - 1;
+
+            const size_t subBucket = static_cast<size_t>(nanoseconds >> (exponent - subBucketBits)) & (subBucketCount - 1);
+            return static_cast<size_t>(exponent - subBucketBits + 1) * subBucketCount + subBucket;
+        }
+
+        // Highest value stored in the bucket
+        static uint64_t highestOf(size_t bucket) {
+            if (bucket < subBucketCount)
+                return bucket;
+
+            const int      shift = static_cast<int>(bucket / subBucketCount) - 1;
+            const uint64_t lower = static_cast<uint64_t>(subBucketCount + bucket % subBucketCount) << shift;
+            return lower + (uint64_t(1) << shift) - 1;
+        }
+
+        // Only called by the owning thread, hence the plain increment
+        void record(uint64_t nanoseconds) {
+            std::atomic<uint64_t>& bucket = buckets_[bucketOf(nanoseconds)];
+            bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+            uint64_t maximum = maximum_.load(std::memory_order_relaxed);
+            while (nanoseconds > maximum && !maximum_.compare_exchange_weak(maximum, nanoseconds, std::memory_order_relaxed)) {}
+        }
+
+        void addTo(Counts& counts) const {
+            for (size_t i = 0; i < bucketCount; ++i)
+                counts[i] += buckets_[i].load(std::memory_order_relaxed);
+        }
+
+        // Maximum since the previous call
+        uint64_t takeMaximum() {
+            return maximum_.exchange(0, std::memory_order_relaxed);
+        }
+
+        uint64_t maximum() const {
+            return maximum_.load(std::memory_order_relaxed);
+        }
+
+        // Highest value of the bucket holding the sample of the given rank, in [0, 1]
+        static uint64_t percentileOf(const Counts& counts, uint64_t count, double rank) {
+            const uint64_t target     = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(rank * static_cast<double>(count))));
+            uint64_t       cumulative = 0;
+            size_t         bucket     = 0;
+            while (bucket + 1 < bucketCount && (cumulative += counts[bucket]) < target)
+                ++bucket;
+            return highestOf(bucket);
+        }
+
+    private:
+        std::array<std::atomic<uint64_t>, bucketCount> buckets_{};
+        std::atomic<uint64_t>                          maximum_{ 0 };
+    };
+
+    /*
+     * @brief Renders a duration with three significant decimals, in the unit
+     *        that fits it, as "12.345 us".
+     */
+    inline std::string formatDuration(uint64_t nanoseconds) {
+        static const char* const units[] = { " us", " ms", " s" };
+
+        if (nanoseconds < 1000)
+            return std::to_string(nanoseconds) + " ns";
+
+        uint64_t divisor = 1000;
+        size_t   unit    = 0;
+        while (unit + 1 < sizeof(units) / sizeof(units[0]) && nanoseconds >= divisor * 1000) {
+            divisor *= 1000;
+            ++unit;
+        }
+
+        char  fraction[8];
+        char* end = writeFixedDigits(fraction, (nanoseconds % divisor) / (divisor / 1000), 3);
+        return std::to_string(nanoseconds / divisor) + '.' + std::string(fraction, end) + units[unit];
+    }
+
+    class ThreadTimers;
+
+} // namespace detail
+
+    /*
+     * @brief Named duration measured by the TL_SCOPED_TIMER expanding it. It
+     *        is created once per expansion, and indexes the histograms that
+     *        every thread keeps for it, so that timing needs neither a lookup
+     *        nor a lock. See Logger::reportTimers.
+     */
+    class TimerSite {
+    public:
+        explicit TimerSite(std::string name);
+
+        TimerSite(const TimerSite&)            = delete;
+        TimerSite& operator=(const TimerSite&) = delete;
+
+        const std::string& name() const {
+            return name_;
+        }
+
+        // Histogram of the calling thread, created on its first use
+        detail::TimerHistogram& threadHistogram() const;
+
+    private:
+        friend struct ::Logger;
+        friend class detail::ThreadTimers;
+
+        const std::string name_;
+        size_t            index_ = 0;
+
+        // Protected by the mutex of the registry
+        detail::TimerHistogram::Counts retired_{};
+        detail::TimerHistogram::Counts reported_{};
+        uint64_t                       retiredMaximum_ = 0;
+    };
+
+namespace detail {
+
+    // Timer sites, and the histograms of the live threads
+    struct TimerRegistry {
+        std::mutex                 mutex;
+        std::vector<TimerSite*>    sites;
+        std::vector<ThreadTimers*> threads;
+    };
+
+    inline TimerRegistry& timerRegistry() {
+        static TimerRegistry registry;
+        return registry;
+    }
+
+    /*
+     * @brief Histograms of a thread, by index of timer site. They are merged
+     *        into their site when the thread exits, so that no sample is lost.
+     */
+    class ThreadTimers {
+    public:
+        ThreadTimers() {
+            TimerRegistry&              registry = timerRegistry();
+            std::lock_guard<std::mutex> guard(registry.mutex);
+            registry.threads.push_back(this);
+        }
+
+        ~ThreadTimers() {
+            TimerRegistry&              registry = timerRegistry();
+            std::lock_guard<std::mutex> guard(registry.mutex);
+
+            for (size_t i = 0; i < histograms_.size(); ++i) {
+                if (!histograms_[i])
+                    continue;
+                TimerSite& site = *registry.sites[i];
+                histograms_[i]->addTo(site.retired_);
+                site.retiredMaximum_ = std::max(site.retiredMaximum_, histograms_[i]->takeMaximum());
+            }
+            registry.threads.erase(std::find(registry.threads.begin(), registry.threads.end(), this));
+        }
+
+        TimerHistogram& histogram(size_t index) {
+            if (index < histograms_.size() && histograms_[index])
+                return *histograms_[index];
+
+            // Only the owning thread changes the vector, and reportTimers reads it
+            TimerRegistry&              registry = timerRegistry();
+            std::lock_guard<std::mutex> guard(registry.mutex);
+            if (index >= histograms_.size())
+                histograms_.resize(index + 1);
+            histograms_[index] = std::make_unique<TimerHistogram>();
+            return *histograms_[index];
+        }
+
+        // Called by reportTimers, under the mutex of the registry
+        TimerHistogram* find(size_t index) const {
+            return index < histograms_.size() ? histograms_[index].get() : nullptr;
+        }
+
+    private:
+        std::vector<std::unique_ptr<TimerHistogram>> histograms_;
+    };
+
+    inline ThreadTimers& threadTimers() {
+        thread_local ThreadTimers timers;
+        return timers;
+    }
+
+} // namespace detail
+
+    inline TimerSite::TimerSite(std::string name) : name_(std::move(name)) {
+        detail::TimerRegistry&      registry = detail::timerRegistry();
+        std::lock_guard<std::mutex> guard(registry.mutex);
+        index_ = registry.sites.size();
+        registry.sites.push_back(this);
+    }
+
+    inline detail::TimerHistogram& TimerSite::threadHistogram() const {
+        return detail::threadTimers().histogram(index_);
+    }
+
+    /*
+     * @brief Summary of a latency histogram, in nanoseconds. Percentiles are
+     *        the upper bounds of their histogram buckets, within 1/16.
+     */
+    struct LatencyStats {
+        uint64_t count = 0;
+        uint64_t p50   = 0;
+        uint64_t p99   = 0;
+        uint64_t p999  = 0;
+        uint64_t max   = 0;
+    };
+
+    /*
+     * @brief Snapshot of the counters of a Logger, see Logger::stats. Counts
+     *        are totals since the logger was created.
+     *
+     * @param levels              Indexed by LogLevel: records emitted, records
+     *                            dropped by a full queue, and calls discarded
+     *                            by the rate-limited macros.
+     * @param sinks               Sinks of the logger, then of its categories.
+     * @param queueCapacity       Records the queue, or the queue of every
+     *                            thread, can hold.
+     * @param queueHighWaterMark  Most records seen waiting in the queue, or in
+     *                            the queue of a thread.
+     * @param threadQueues        Queues of the threads, see AsyncOptions.
+     * @param blockedTime         Time producers waited for logMutex_, or for
+     *                            room in a full queue.
+     * @param formatLatency       Backend time rendering a line.
+     * @param writeLatency        Backend time handing a record to the sinks.
+     * @param formatHeapFallbacks Lines too long for the FormatBuffer.
+     * @param arenaRecords        Records stored in the arena, see AsyncOptions.
+     * @param arenaBlocked        Records that waited for a free slab.
+     * @param arenaDropped        Records dropped, as no slab was free.
+     * @param arenaHeapFallbacks  Records stored on the heap, as no slab was
+     *                            free or the record is larger than a slab.
+     */
+    struct LoggerStats {
+        struct LevelStats {
+            uint64_t emitted    = 0;
+            uint64_t dropped    = 0;
+            uint64_t suppressed = 0;
+        };
+
+        std::array<LevelStats, 8> levels{};
+        std::vector<SinkStats>    sinks;
+        size_t                    queueCapacity       = 0;
+        size_t                    queueHighWaterMark  = 0;
+        size_t                    threadQueues        = 0;
+        std::chrono::nanoseconds  blockedTime{ 0 };
+        LatencyStats              formatLatency;
+        LatencyStats              writeLatency;
+        size_t                    formatHeapFallbacks = 0;
+        uint64_t                  arenaRecords        = 0;
+        uint64_t                  arenaBlocked        = 0;
+        uint64_t                  arenaDropped        = 0;
+        uint64_t                  arenaHeapFallbacks  = 0;
+
+        const LevelStats& operator[](LogLevel logLevel) const {
+            return levels[static_cast<size_t>(logLevel)];
+        }
+    };
+
+namespace detail {
+
+    /*
+     * @brief Counters of the producers, one stripe per thread modulo the
+     *        stripe count, so that threads do not write the same cache line.
+     */
+    struct alignas(cacheLineSize) StatsStripe {
+        std::array<std::atomic<uint64_t>, 8> emitted{};
+        std::array<std::atomic<uint64_t>, 8> dropped{};
+        std::array<std::atomic<uint64_t>, 8> suppressed{};
+        std::atomic<uint64_t>                blockedTicks{ 0 };
+        std::atomic<uint64_t>                arenaRecords{ 0 };
+        std::atomic<uint64_t>                arenaBlocked{ 0 };
+        std::atomic<uint64_t>                arenaDropped{ 0 };
+        std::atomic<uint64_t>                arenaHeapFallbacks{ 0 };
+    };
+
+    inline LatencyStats summarize(const TimerHistogram& histogram) {
+        TimerHistogram::Counts counts{};
+        histogram.addTo(counts);
+
+        LatencyStats stats;
+        for (uint64_t count : counts)
+            stats.count += count;
+        if (!stats.count)
+            return stats;
+
+        stats.max  = histogram.maximum();
+        stats.p50  = std::min(TimerHistogram::percentileOf(counts, stats.count, 0.50),  stats.max);
+        stats.p99  = std::min(TimerHistogram::percentileOf(counts, stats.count, 0.99),  stats.max);
+        stats.p999 = std::min(TimerHistogram::percentileOf(counts, stats.count, 0.999), stats.max);
+        return stats;
+    }
+
+    // Label value of the Prometheus text format, with its escapes
+    inline void appendPrometheusLabel(std::string& output, std::string_view value) {
+        for (char character : value) {
+            if (character == '\\' || character == '"')
+                output += '\\';
+            if (character == '\n')
+                output += "\\n";
+            else
+                output += character;
+        }
+    }
+
+} // namespace detail
+
+    /*
+     * @brief Renders the statistics in the Prometheus text exposition format,
+     *        to be returned by the scrape endpoint of the program, as with
+     *        handler = [] { return tl::prometheusText(logger.stats()); }.
+     *
+     * @param stats  Snapshot returned by Logger::stats.
+     * @param prefix Prepended to the name of every metric.
+     */
+    inline std::string prometheusText(const LoggerStats& stats, std::string_view prefix = "tinylogger") {
+        std::string output;
+        const auto  metric = [&output, prefix](const char* name, const char* type, const char* help) {
+            output.append("# HELP ").append(prefix).append(name).append(" ").append(help).append("\n");
+            output.append("# TYPE ").append(prefix).append(name).append(" ").append(type).append("\n");
+        };
+        const auto sample = [&output, prefix](const char* name, const std::string& labels, double value) {
+            char         number[32];
+            const size_t size = static_cast<size_t>(std::snprintf(number, sizeof(number), "%.17g", value));
+            output.append(prefix).append(name);
+            if (!labels.empty())
+                output.append("{").append(labels).append("}");
+            output.append(" ").append(number, size).append("\n");
+        };
+
+        const auto levelMetric = [&](const char* name, const char* help, uint64_t LoggerStats::LevelStats::* field) {
+            metric(name, "counter", help);
+            for (size_t level = static_cast<size_t>(LogLevel::CRITICAL); level < stats.levels.size(); ++level)
+                sample(name, std::string("level=\"") + detail::levelName(static_cast<LogLevel>(level)) + "\"",
+                       static_cast<double>(stats.levels[level].*field));
+        };
+        levelMetric("_records_emitted_total",    "Records logged, at an enabled level.",            &LoggerStats::LevelStats::emitted);
+        levelMetric("_records_dropped_total",    "Records dropped because the queue was full.",     &LoggerStats::LevelStats::dropped);
+        levelMetric("_records_suppressed_total", "Calls discarded by the rate-limited macros.",     &LoggerStats::LevelStats::suppressed);
+
+        const auto sinkMetric = [&](const char* name, const char* help, uint64_t SinkStats::* field) {
+            metric(name, "counter", help);
+            for (size_t i = 0; i < stats.sinks.size(); ++i) {
+                std::string labels = "sink=\"";
+                detail::appendPrometheusLabel(labels, stats.sinks[i].name);
+                labels += "\",index=\"" + std::to_string(i) + "\"";
+                sample(name, labels, static_cast<double>(stats.sinks[i].*field));
+            }
+        };
+        sinkMetric("_sink_records_total", "Lines or records handed to the sink.",      &SinkStats::records);
+        sinkMetric("_sink_bytes_total",   "Bytes of the lines handed to the sink.",    &SinkStats::bytes);
+        sinkMetric("_sink_dropped_total", "Lines discarded by the sink.",              &SinkStats::dropped);
+        sinkMetric("_sink_writes_total",  "System calls the lines were written with.", &SinkStats::writes);
+
+        metric("_queue_capacity", "gauge", "Records the asynchronous queue can hold.");
+        sample("_queue_capacity", "", static_cast<double>(stats.queueCapacity));
+        metric("_queue_high_water_mark", "gauge", "Most records seen waiting in the queue.");
+        sample("_queue_high_water_mark", "", static_cast<double>(stats.queueHighWaterMark));
+        metric("_thread_queues", "gauge", "Queues of the threads logging, with thread queues.");
+        sample("_thread_queues", "", static_cast<double>(stats.threadQueues));
+        metric("_blocked_seconds_total", "counter", "Time producers waited for the logger lock or the queue.");
+        sample("_blocked_seconds_total", "", static_cast<double>(stats.blockedTime.count()) * 1e-9);
+        metric("_format_heap_fallbacks_total", "counter", "Lines too long for the format buffer.");
+        sample("_format_heap_fallbacks_total", "", static_cast<double>(stats.formatHeapFallbacks));
+        metric("_arena_records_total", "counter", "Records stored in the arena.");
+        sample("_arena_records_total", "", static_cast<double>(stats.arenaRecords));
+        metric("_arena_exhausted_total", "counter", "Records finding no room in the arena, by outcome.");
+        sample("_arena_exhausted_total", "outcome=\"blocked\"", static_cast<double>(stats.arenaBlocked));
+        sample("_arena_exhausted_total", "outcome=\"dropped\"", static_cast<double>(stats.arenaDropped));
+        sample("_arena_exhausted_total", "outcome=\"heap\"",    static_cast<double>(stats.arenaHeapFallbacks));
+
+        const auto latencyMetric = [&](const char* name, const char* help, const LatencyStats& latency) {
+            metric(name, "summary", help);
+            sample(name, "quantile=\"0.5\"",   static_cast<double>(latency.p50)  * 1e-9);
+            sample(name, "quantile=\"0.99\"",  static_cast<double>(latency.p99)  * 1e-9);
+            sample(name, "quantile=\"0.999\"", static_cast<double>(latency.p999) * 1e-9);
+            sample(name, "quantile=\"1\"",     static_cast<double>(latency.max)  * 1e-9);
+            output.append(prefix).append(name).append("_count ").append(std::to_string(latency.count)).append("\n");
+        };
+        latencyMetric("_backend_format_seconds", "Backend time rendering a line.",          stats.formatLatency);
+        latencyMetric("_backend_write_seconds",  "Backend time handing a record to sinks.", stats.writeLatency);
+
+        return output;
+    }
+
+    /*
+     * Limiters of the rate-limited macros, one per expansion. Their admit
+     * function tells whether a call is logged, and then sets suppressed to
+     * the number of calls discarded since the previous logged one. They only
+     * use atomics, so that a discarded call costs a few nanoseconds.
+     */
+
+    // Admits one call out of n, see LOG_<LEVEL>_EVERY_N
+    class EveryN {
+    public:
+        explicit EveryN(uint64_t n) : n_(std::max<uint64_t>(n, 1)) {}
+
+        bool admit(uint64_t& suppressed) {
+            const uint64_t call = calls_.fetch_add(1, std::memory_order_relaxed);
+            if (call % n_)
+                return false;
+
+            suppressed = call ? n_ - 1 : 0;
+            return true;
+        }
+
+    private:
+        const uint64_t        n_;
+        std::atomic<uint64_t> calls_{ 0 };
+    };
+
+    // Admits at most one call per interval, see LOG_<LEVEL>_EVERY_MS
+    class EveryInterval {
+    public:
+        explicit EveryInterval(std::chrono::nanoseconds interval)
+            : interval_(static_cast<uint64_t>(static_cast<double>(interval.count()) / detail::TickClock::nanosecondsPerTick())) {}
+
+        bool admit(uint64_t& suppressed) {
+            const uint64_t ticks = detail::TickClock::now();
+            uint64_t       next  = next_.load(std::memory_order_relaxed);
+            if (ticks < next || !next_.compare_exchange_strong(next, ticks + interval_, std::memory_order_relaxed)) {
+                suppressed_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+
+            suppressed = suppressed_.exchange(0, std::memory_order_relaxed);
+            return true;
+        }
+
+    private:
+        const uint64_t        interval_;
+        std::atomic<uint64_t> next_{ 0 };
+        std::atomic<uint64_t> suppressed_{ 0 };
+    };
+
+    /*
+     * @brief Token bucket refilled with rate tokens per second, holding up to
+     *        burst of them, see LOG_<LEVEL>_RATE_LIMITED. Implemented as the
+     *        generic cell rate algorithm, so that its whole state is the time
+     *        at which the bucket would be full again, in ticks.
+     */
+    class TokenBucket {
+    public:
+        TokenBucket(double rate, uint64_t burst)
+            : emission_(static_cast<uint64_t>(1e9 / (std::max(rate, 1e-9) * detail::TickClock::nanosecondsPerTick()))),
+              tolerance_(emission_ * (std::max<uint64_t>(burst, 1) - 1)) {}
+
+        bool admit(uint64_t& suppressed) {
+            const uint64_t ticks = detail::TickClock::now();
+            uint64_t       full  = full_.load(std::memory_order_relaxed);
+            for (;;) {
+                const uint64_t start = std::max(full, ticks);
+                if (start - ticks > tolerance_) {
+                    suppressed_.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+                if (full_.compare_exchange_weak(full, start + emission_, std::memory_order_relaxed))
+                    break;
+            }
+
+            suppressed = suppressed_.exchange(0, std::memory_order_relaxed);
+            return true;
+        }
+
+    private:
+        const uint64_t        emission_;
+        const uint64_t        tolerance_;
+        std::atomic<uint64_t> full_{ 0 };
+        std::atomic<uint64_t> suppressed_{ 0 };
+    };
+
+    class ProgressBar;
+
+namespace detail {
+
+    /*
+     * @brief Terminal block where the shown progress bars are drawn, one per
+     *        line, in the order they were shown. Redraws are throttled: the
+     *        thread whose progress comes first after the interval wins a CAS
+     *        and draws, the other ones only read the time.
+     */
+    class ProgressDisplay {
+    public:
+        explicit ProgressDisplay(std::ostream& stream)
+            : stream_(stream),
+              redrawInterval_(static_cast<uint64_t>(1e8 / TickClock::nanosecondsPerTick())) {}
+
+        void redrawIfDue() {
+            const uint64_t ticks = TickClock::now();
+            uint64_t       next  = nextRedraw_.load(std::memory_order_relaxed);
+            if (ticks < next || !nextRedraw_.compare_exchange_strong(next, ticks + redrawInterval_, std::memory_order_relaxed))
+                return;
+
+            std::lock_guard<std::mutex> guard(mutex_);
+            draw(ticks);
+        }
+
+        // Visibility of the bars only changes under the lock, so that a bar
+        // finished by a thread cannot be shown again by a late one
+        void show(ProgressBar& bar);
+
+        // Draws the block a last time, and leaves it above the next bars
+        void finish(ProgressBar& bar);
+
+    private:
+        void draw(uint64_t ticks);
+
+        std::ostream&                                stream_;
+        const uint64_t                               redrawInterval_;
+        alignas(cacheLineSize) std::atomic<uint64_t> nextRedraw_{ 0 };
+
+        // Protected by mutex_
+        std::mutex                      mutex_;
+        std::vector<const ProgressBar*> bars_;
+        size_t                          drawnLines_ = 0;
+    };
+
+    inline ProgressDisplay& progressDisplay() {
+        static ProgressDisplay display(std::cout);
+        return display;
+    }
+
+    // Counter of the progress bars a thread adds to, spreading the threads
+    inline size_t threadStripe() {
+        static std::atomic<size_t> threadCount{ 0 };
+        thread_local const size_t  stripe = threadCount.fetch_add(1, std::memory_order_relaxed);
+        return stripe;
+    }
+
+    // NUMA node of the processor running the calling thread, 0 if unknown
+    inline size_t currentNumaNode() {
+#ifdef _WIN32
+        PROCESSOR_NUMBER processor;
+        USHORT           node = 0;
+        GetCurrentProcessorNumberEx(&processor);
+        if (GetNumaProcessorNodeEx(&processor, &node))
+            return node;
+#elif defined(__linux__) && defined(SYS_getcpu)
+        unsigned processor = 0;
+        unsigned node      = 0;
+        if (syscall(SYS_getcpu, &processor, &node, nullptr) == 0)
+            return node;
+#endif
+        return 0;
+    }
+
+    // Renders a number of iterations per second, as "1.25M"
+    inline std::string formatRate(double rate) {
+        static const char* const suffixes[] = { "", "k", "M", "G", "T" };
+
+        size_t suffix = 0;
+        while (rate >= 1000.0 && suffix + 1 < sizeof(suffixes) / sizeof(suffixes[0])) {
+            rate /= 1000.0;
+            ++suffix;
+        }
+
+        char text[32];
+        std::snprintf(text, sizeof(text), "%.2f%s", rate, suffixes[suffix]);
+        return text;
+    }
+
+} // namespace detail
+
+    /*
+     * @brief Progress of a loop over total iterations, drawn on the console
+     *        with its percentage, throughput and estimated remaining time:
+     *          copy [=============>                ]  45% 1.25M it/s ETA 0:00:42
+     *
+     *        advance can be called by all the threads of a parallel loop: it
+     *        only does a relaxed fetch_add on the counter of the thread, then
+     *        reads the time to know if the bars must be redrawn. Several bars
+     *        can progress at the same time, each one on its own line.
+     *
+     *        The bar is shown on its first progress, and drawn a last time by
+     *        finish, called by the destructor if needed.
+     */
+    class ProgressBar {
+    public:
+        ProgressBar(std::string name, size_t total) : name_(std::move(name)) {
+            reset(total);
+        }
+
+        ~ProgressBar() {
+            finish();
+        }
+
+        ProgressBar(const ProgressBar&)            = delete;
+        ProgressBar& operator=(const ProgressBar&) = delete;
+
+        void advance(size_t iterations = 1) {
+            stripes_[detail::threadStripe() % stripeCount].count.fetch_add(iterations, std::memory_order_relaxed);
+            show();
+            detail::progressDisplay().redrawIfDue();
+        }
+
+        // Raises the number of completed iterations to the index the calling
+        // thread reached, so that threads reporting out of order never move it
+        // back. Once every iteration is done, later reports are ignored.
+        void update(size_t completed) {
+            std::atomic<size_t>& count    = stripes_[0].count;
+            size_t               previous = count.load(std::memory_order_relaxed);
+            while (previous < completed && !count.compare_exchange_weak(previous, completed, std::memory_order_relaxed)) {}
+            if (previous >= total())
+                return;
+
+            show();
+            if (completed >= total())
+                finish();
+            else
+                detail::progressDisplay().redrawIfDue();
+        }
+
+        // Starts a new loop, must not be called while other threads advance
+        void reset(size_t total) {
+            finish();
+            for (Stripe& stripe : stripes_)
+                stripe.count.store(0, std::memory_order_relaxed);
+            total_.store(total, std::memory_order_relaxed);
+            startTicks_.store(detail::TickClock::now(), std::memory_order_relaxed);
+            visibility_.store(Visibility::HIDDEN, std::memory_order_relaxed);
+        }
+
+        void finish() {
+            if (visibility_.load(std::memory_order_relaxed) != Visibility::DONE)
+                detail::progressDisplay().finish(*this);
+        }
+
+        size_t completed() const {
+            size_t completed = 0;
+            for (const Stripe& stripe : stripes_)
+                completed += stripe.count.load(std::memory_order_relaxed);
+            return completed;
+        }
+
+        size_t total() const {
+            return total_.load(std::memory_order_relaxed);
+        }
+
+        // Line of the bar, without the new line character
+        std::string render(uint64_t ticks) const {
+            static const size_t width = 30;
+
+            const size_t total     = std::max<size_t>(this->total(), 1);
+            const size_t completed = std::min(this->completed(), total);
+            const size_t filled    = completed * width / total;
+            const double seconds   = static_cast<double>(detail::TickClock::toNanoseconds(
+                                         static_cast<int64_t>(ticks - startTicks_.load(std::memory_order_relaxed)))) / 1e9;
+            const double rate      = seconds > 0.0 ? static_cast<double>(completed) / seconds : 0.0;
+
+            std::string line;
+            if (!name_.empty())
+                line += name_ + ' ';
+            line += '[' + std::string(filled, '=');
+            if (filled < width)
+                line += '>' + std::string(width - filled - 1, ' ');
+
+            char percentage[8];
+            std::snprintf(percentage, sizeof(percentage), "] %3zu%% ", completed * 100 / total);
+            line += percentage + detail::formatRate(rate) + " it/s ETA ";
+
+            if (completed == total || rate <= 0.0)
+                return line + (completed == total ? "0:00:00" : "-:--:--");
+
+            const uint64_t remaining = static_cast<uint64_t>(static_cast<double>(total - completed) / rate);
+            char eta[32];
+            std::snprintf(eta, sizeof(eta), "%llu:%02u:%02u", static_cast<unsigned long long>(remaining / 3600),
+                          static_cast<unsigned>(remaining / 60 % 60), static_cast<unsigned>(remaining % 60));
+            return line + eta;
+        }
+
+    private:
+        friend class detail::ProgressDisplay;
+
+        static constexpr size_t stripeCount = 16;
+
+        struct alignas(detail::cacheLineSize) Stripe {
+            std::atomic<size_t> count{ 0 };
+        };
+
+        // A finished bar stays done until the next reset
+        enum class Visibility { HIDDEN, SHOWN, DONE };
+
+        void show() {
+            if (visibility_.load(std::memory_order_relaxed) == Visibility::HIDDEN)
+                detail::progressDisplay().show(*this);
+        }
+
+        const std::string                name_;
+        std::array<Stripe, stripeCount>  stripes_;
+        std::atomic<size_t>              total_{ 0 };
+        std::atomic<uint64_t>            startTicks_{ 0 };
+        std::atomic<Visibility>          visibility_{ Visibility::HIDDEN };
+    };
+
+namespace detail {
+
+    inline void ProgressDisplay::show(ProgressBar& bar) {
+        std::lock_guard<std::mutex> guard(mutex_);
+        if (bar.visibility_.load(std::memory_order_relaxed) != ProgressBar::Visibility::HIDDEN)
+            return;
+
+        bar.visibility_.store(ProgressBar::Visibility::SHOWN, std::memory_order_relaxed);
+        bars_.push_back(&bar);
+    }
+
+    inline void ProgressDisplay::finish(ProgressBar& bar) {
+        std::lock_guard<std::mutex> guard(mutex_);
+        if (bar.visibility_.exchange(ProgressBar::Visibility::DONE, std::memory_order_relaxed) != ProgressBar::Visibility::SHOWN)
+            return;
+
+        draw(TickClock::now());
+        stream_ << '\n';
+        stream_.flush();
+
+        drawnLines_ = 0;
+        bars_.erase(std::remove(bars_.begin(), bars_.end(), &bar), bars_.end());
+    }
+
+    // Moves up to the first line of the block, then draws every bar over it
+    inline void ProgressDisplay::draw(uint64_t ticks) {
+        std::string block;
+        if (drawnLines_ > 1)
+            block += "\033[" + std::to_string(drawnLines_ - 1) + 'A';
+
+        for (size_t i = 0; i < bars_.size(); ++i) {
+            std::string line = bars_[i]->render(ticks);
+            if (line.size() < 79)
+                line.resize(79, ' ');
+            block += (i ? "\n\r" : "\r") + line;
+        }
+
+        stream_ << block;
+        stream_.flush();
+        drawnLines_ = bars_.size();
+    }
+
+} // namespace detail
+
+
+    /*
+     * =========================================================================
+     *                          Runtime Configuration
+     * =========================================================================
+     *
+     * Levels can be set without code, by a list of entries separated by commas,
+     * semicolons or new lines, as "INFO, net=TRACE, db=WARNING": a level alone
+     * is the one of the logger, and name=level the one of a category. Levels
+     * are named as in the lines, in any case, or given by their number. Text
+     * after a '#' is ignored up to the end of its line.
+     *
+     * The default logger reads them from the TINYLOGGER_LEVEL variable of the
+     * environment, and watches the file named by TINYLOGGER_CONFIG, if any.
+     * See Logger::configure and Logger::watchConfig.
+     */
+
+namespace detail {
+
+    // Level named as in the lines, WARN and LERROR being accepted too
+    inline bool parseLogLevel(std::string_view text, LogLevel& logLevel) {
+        if (text.size() == 1 && text[0] >= '0' && text[0] <= '7') {
+            logLevel = static_cast<LogLevel>(text[0] - '0');
+            return true;
+        }
+
+        std::string name(text);
+        std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+        if (name == "WARN")
+            name = "WARNING";
+        else if (name == "LERROR")
+            name = "ERROR";
+
+        for (int level = static_cast<int>(LogLevel::OFF); level <= static_cast<int>(LogLevel::TRACE); ++level)
+            if (name == levelName(static_cast<LogLevel>(level))) {
+                logLevel = static_cast<LogLevel>(level);
+                return true;
+            }
+        return false;
+    }
+
+    // Levels given by a configuration, see Runtime Configuration
+    struct LevelConfig {
+        std::optional<LogLevel>                       logLevel;
+        std::vector<std::pair<std::string, LogLevel>> categories;
+    };
+
+    inline std::string_view trimmed(std::string_view text) {
+        const char* spaces = " \t\r";
+        const size_t first = text.find_first_not_of(spaces);
+        if (first == std::string_view::npos)
+            return std::string_view();
+        return text.substr(first, text.find_last_not_of(spaces) - first + 1);
+    }
+
+    // Fails on the first invalid entry, config being then left incomplete
+    inline bool parseLevelConfig(std::string_view text, LevelConfig& config) {
+        while (!text.empty()) {
+            const size_t     separator = text.find_first_of(",;\n");
+            std::string_view entry     = text.substr(0, separator);
+            const bool       isLineEnd = separator != std::string_view::npos && text[separator] == '\n';
+            text = separator == std::string_view::npos ? std::string_view() : text.substr(separator + 1);
+
+            // Comments go up to the end of the line, over the other separators
+            const size_t comment = entry.find('#');
+            if (comment != std::string_view::npos) {
+                entry = entry.substr(0, comment);
+                if (!isLineEnd) {
+                    const size_t lineEnd = text.find('\n');
+                    text = lineEnd == std::string_view::npos ? std::string_view() : text.substr(lineEnd + 1);
+                }
+            }
+
+            entry = trimmed(entry);
+            if (entry.empty())
+                continue;
+
+            LogLevel     logLevel;
+            const size_t equal = entry.find('=');
+            if (equal == std::string_view::npos) {
+                if (!parseLogLevel(entry, logLevel))
+                    return false;
+                config.logLevel = logLevel;
+                continue;
+            }
+
+            const std::string_view name = trimmed(entry.substr(0, equal));
+            if (name.empty() || !parseLogLevel(trimmed(entry.substr(equal + 1)), logLevel))
+                return false;
+            config.categories.emplace_back(std::string(name), logLevel);
+        }
+        return true;
+    }
+
+    // Whole content of a file, false if it cannot be read
+    inline bool readFile(const std::filesystem::path& path, std::string& content) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+            return false;
+        content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        return !file.bad();
+    }
+
+    /*
+     * @brief Wakes up its thread when a file of a directory changes, with
+     *        inotify on Linux and change notifications on Windows. Elsewhere,
+     *        or if the directory cannot be watched, wait only times out.
+     */
+    class DirectoryWatcher {
+    public:
+        explicit DirectoryWatcher(const std::filesystem::path& directory) {
+            #if defined(_WIN32)
+            stopEvent_ = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+            change_    = FindFirstChangeNotificationW(directory.c_str(), FALSE, FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE);
+            #elif defined(__linux__)
+            // Editors often replace the file, which is then moved or created in the directory
+            notifyFile_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+            if (notifyFile_ >= 0 && inotify_add_watch(notifyFile_, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE) < 0) {
+                close(notifyFile_);
+                notifyFile_ = -1;
+            }
+            if (pipe2(stopPipe_, O_NONBLOCK | O_CLOEXEC) < 0)
+                stopPipe_[0] = stopPipe_[1] = -1;
+            #else
+            (void)directory;
+            #endif
+        }
+
+        ~DirectoryWatcher() {
+            #if defined(_WIN32)
+            if (change_ != INVALID_HANDLE_VALUE)
+                FindCloseChangeNotification(change_);
+            if (stopEvent_)
+                CloseHandle(stopEvent_);
+            #elif defined(__linux__)
+            for (int file : { notifyFile_, stopPipe_[0], stopPipe_[1] })
+                if (file >= 0)
+                    close(file);
+            #endif
+        }
+
+        DirectoryWatcher(const DirectoryWatcher&)            = delete;
+        DirectoryWatcher& operator=(const DirectoryWatcher&) = delete;
+
+        // Tells whether wait returns on changes, rather than only on timeouts
+        bool isNotified() const {
+            #if defined(_WIN32)
+            return change_ != INVALID_HANDLE_VALUE && stopEvent_;
+            #elif defined(__linux__)
+            return notifyFile_ >= 0 && stopPipe_[0] >= 0;
+            #else
+            return false;
+            #endif
+        }
+
+        // Waits for a change, or up to timeout if not notified; false once stopped
+        bool wait(std::chrono::milliseconds timeout) {
+            #if defined(_WIN32)
+            if (isNotified()) {
+                const HANDLE handles[] = { stopEvent_, change_ };
+                const DWORD  result    = WaitForMultipleObjects(2, handles, FALSE, INFINITE);
+                if (result == WAIT_OBJECT_0 + 1)
+                    FindNextChangeNotification(change_);
+                return result != WAIT_OBJECT_0 && !isStopped_.load(std::memory_order_acquire);
+            }
+            #elif defined(__linux__)
+            if (isNotified()) {
+                pollfd files[] = { { stopPipe_[0], POLLIN, 0 }, { notifyFile_, POLLIN, 0 } };
+                if (poll(files, 2, -1) > 0 && (files[1].revents & POLLIN)) {
+                    char events[4096];
+                    while (read(notifyFile_, events, sizeof(events)) > 0) {}
+                }
+                return !isStopped_.load(std::memory_order_acquire);
+            }
+            #endif
+
+            std::unique_lock<std::mutex> lock(mutex_);
+            return !stopped_.wait_for(lock, timeout, [this]() { return isStopped_.load(std::memory_order_acquire); });
+        }
+
+        void stop() {
+            {
+                std::lock_guard<std::mutex> guard(mutex_);
+                isStopped_.store(true, std::memory_order_release);
+            }
+            stopped_.notify_all();
+
+            #if defined(_WIN32)
+            if (stopEvent_)
+                SetEvent(stopEvent_);
+            #elif defined(__linux__)
+            if (stopPipe_[1] >= 0)
+                (void)!write(stopPipe_[1], "", 1);
+            #endif
+        }
+
+    private:
+        #if defined(_WIN32)
+        HANDLE stopEvent_ = nullptr;
+        HANDLE change_    = INVALID_HANDLE_VALUE;
+        #elif defined(__linux__)
+        int    notifyFile_  = -1;
+        int    stopPipe_[2] = { -1, -1 };
+        #endif
+
+        std::atomic<bool>       isStopped_{ false };
+        std::mutex              mutex_;
+        std::condition_variable stopped_;
+    };
+
+} // namespace detail
+
+} // namespace tl
+
+
+struct Logger {
+public:
+    /*
+	 * @brief Constructs a Logger instance, with the specified log level.
+     * 
+	 * @param logLevel The initial log level for the logger. See LogLevel
+	 *                 enum class for available log levels.
+     * 
+	 * @note /!\ Caution: This constructor will be called only once, when
+     *           all the header is included in the code, thanks to inline
+     *           Logger instance, declared at the end of this struct. 
+	 *           The user, once that the header is included does not have
+                 to declare another instance, and can directly use macros
+     */
+    Logger(LogLevel logLevel) : logLevel_(logLevel) {
+        // Also measures the tick clock now, rather than on the first record
+        setTimerReportInterval(std::chrono::seconds(10));
+
+        // Created first, so that it outlives the progress bar of the logger
+        tl::detail::progressDisplay();
+    }
+
+    /*
+	 * @brief Concatenates arguments, and logs at the specified level.
+     * 
+	 * This function is the entry point when logging without the macros,
+	 * the level being only known at runtime. The macros call logAt, or
+	 * logDirect when maximum log level is defined at compilation time.
+     *
+	 * @tparam Args (variadic): Any arguments, of any streamable type.
+     * 
+	 * @param logLevel Log level at which the message should be logged
+	 * @param args    (variadic): Any arguments of any streamable type
+     * 
+     * @note It is strongly recommended to use the macros, rather than
+	 *       this function directly. The macros will optimise the code
+	 *       performance and may reduce the binary size.
+     */
+    template <typename... Args>
+    INLINING_TINYLOGGER void log(LogLevel logLevel, Args&&... args) const {
+        if (logLevel > LogLevel::OFF && logLevel <= LogLevel::TRACE && logLevel <= logLevel_.load(std::memory_order_relaxed)) {
+            const tl::detail::ArgumentTuple<Args...> arguments(args...);
+            logPacked(tl::detail::levelCallSite(logLevel), tl::detail::packArguments<Args...>(arguments));
+        }
+    }
+
+    /*
+     * @brief Logs at the level of the given call site, if enabled.
+     *
+     * @param callSite Static description of the logging statement.
+     * @param args    (variadic): Any arguments of any streamable type
+     */
+    template <typename... Args>
+    INLINING_TINYLOGGER void logAt(const tl::CallSite& callSite, Args&&... args) const {
+        if (callSite.logLevel <= thresholdOf(callSite))
+            logDirect(callSite, std::forward<Args>(args)...);
+    }
+
+    /*
+     * @brief Tells whether a call site is enabled, using the answer cached
+     *        in the call site until the log level changes. This is checked
+     *        by the macros before their arguments are evaluated.
+     *
+     * @note A call site caches the answer of a single logger: the macros
+     *       only check their call sites against the same logger.
+     */
+    INLINING_TINYLOGGER bool isEnabled(const tl::CallSite& callSite) const {
+        const uint32_t generation = tl::detail::levelGeneration.load(std::memory_order_acquire);
+        const uint32_t cached     = callSite.cachedState.load(std::memory_order_relaxed);
+        if ((cached >> 1) == generation)
+            return cached & 1;
+
+        const bool enabled = callSite.logLevel <= thresholdOf(callSite);
+        callSite.cachedState.store((generation << 1) | (enabled ? 1 : 0), std::memory_order_relaxed);
+        return enabled;
+    }
+
+    /*
+     * @brief Same as logAt, without checking the runtime log level. It is
+     *        used by the macros once their call site is known to be enabled.
+     *
+     * @note Like every logging function, it only references its arguments,
+     *       and hands them to logPacked, the non-template backend.
+     */
+    template <typename... Args>
+    INLINING_TINYLOGGER void logDirect(const tl::CallSite& callSite, Args&&... args) const {
+        const tl::detail::ArgumentTuple<Args...> arguments(args...);
+        logPacked(callSite, tl::detail::packArguments<Args...>(arguments));
+    }
+
+    template <typename... Args>
+    [[noreturn]] INLINING_TINYLOGGER void logDirectCritical(const tl::CallSite& callSite, Args&&... args) const {
+        const tl::detail::ArgumentTuple<Args...> arguments(args...);
+        emit(callSite, tl::detail::packArguments<Args...>(arguments));
+        terminate();
+    }
+
+    template <typename... Args>
+    INLINING_TINYLOGGER void logTRACE(Args&&... args) const {
+        logLevelDirect(LogLevel::TRACE, std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    INLINING_TINYLOGGER void logDEBUG(Args&&... args) const {
+        logLevelDirect(LogLevel::DEBUG, std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    INLINING_TINYLOGGER void logVERBOSE(Args&&... args) const {
+        logLevelDirect(LogLevel::VERBOSE, std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    INLINING_TINYLOGGER void logINFO(Args&&... args) const {
+        logLevelDirect(LogLevel::INFO, std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    INLINING_TINYLOGGER void logWARNING(Args&&... args) const {
+        logLevelDirect(LogLevel::WARNING, std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    INLINING_TINYLOGGER void logERROR(Args&&... args) const {
+        logLevelDirect(LogLevel::LERROR, std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    [[noreturn]] INLINING_TINYLOGGER void logCRITICAL(Args&&... args) const {
+        logLevelDirect(LogLevel::CRITICAL, std::forward<Args>(args)...);
+        terminate();
+    }
+
+    /*
+     * @brief Backend of the logging functions: records the packed arguments
+     *        in the backtrace if the call site is only recorded, or writes
+     *        them, then exits after a CRITICAL record. It is compiled once
+     *        by the tinylogger library, see TINYLOGGER_COMPILED.
+     */
+    void logPacked(const tl::CallSite& callSite, const tl::detail::ArgumentPack& pack) const;
+
+    ~Logger() {
+        stopWatchingConfig();
+        stopAsync();
+        disableBacktrace();
+    }
+
+    /*
+     * @brief Switches the logger to the asynchronous mode.
+     *
+     * Producers then only push their record into a bounded lock-free queue
+     * and a dedicated backend thread formats and writes it. The queue is
+     * shared by the threads, or one per thread with options.threadQueues.
+     * Calling it again while the asynchronous mode is running has no effect.
+     *
+     * @param options Queue capacity, overflow policy and backend sleep time.
+     *
+     * @note /!\ Caution: Switching modes is not synchronised with the logging
+     *           functions, and must be done while no other thread is logging.
+     */
+    void startAsync(const AsyncOptions& options = AsyncOptions()) {
+        if (isAsync())
+            return;
+
+        asyncOptions_ = options;
+        asyncSession_ = std::make_shared<AsyncSession>();
+        if (options.arenaCapacity) {
+            // Without memory for a single slab, records go to the heap
+            asyncSession_->arena = std::make_unique<tl::detail::RecordArena>(options.arenaCapacity, options.arenaSlabSize);
+            if (!asyncSession_->arena->slabCount())
+                asyncSession_->arena.reset();
+        }
+        arena_ = asyncSession_->arena.get();
+
+        asyncRunning_.store(true, std::memory_order_release);
+        if (!options.threadQueues) {
+            asyncQueue_ = std::make_unique<tl::detail::BoundedQueue<AsyncRecord>>(options.queueCapacity);
+            asyncThreads_.emplace_back(&Logger::backendLoop, this, 0);
+            return;
+        }
+
+        hasThreadQueues_ = true;
+        shardQueues_.assign(std::max<size_t>(options.numaShards, 1), {});
+        asyncSession_->shardReaders = std::make_unique<std::atomic<ShardReader>[]>(shardQueues_.size());
+        for (size_t shard = 0; shard < shardQueues_.size(); ++shard)
+            asyncThreads_.emplace_back(&Logger::backendLoop, this, shard);
+    }
+
+    /*
+     * @brief Drains the queue, stops the backend thread and switches back to
+     *        the synchronous mode. Called automatically at destruction.
+     *
+     * @note Same caution as startAsync applies to this function.
+     */
+    void stopAsync() {
+        if (!isAsync())
+            return;
+
+        asyncRunning_.store(false, std::memory_order_release);
+        for (std::thread& thread : asyncThreads_)
+            thread.join();
+        asyncThreads_.clear();
+
+        {
+            std::lock_guard<std::mutex> guard(threadQueuesMutex_);
+            shardQueues_.clear();
+            threadQueuesVersion_.fetch_add(1, std::memory_order_release);
+        }
+
+        // Threads holding the session, and its arena, drop it on their next record
+        asyncSession_->isClosed.store(true, std::memory_order_release);
+        asyncSession_.reset();
+        arena_           = nullptr;
+        hasThreadQueues_ = false;
+        asyncQueue_.reset();
+    }
+
+    /*
+     * @brief Blocks until every record logged before this call is written,
+     *        then flushes every sink.
+     */
+    void flush() const {
+        if (asyncQueue_) {
+            const size_t target = enqueuedRecords_.load(std::memory_order_acquire);
+            while (processedRecords_.load(std::memory_order_acquire) < target)
+                std::this_thread::yield();
+        }
+
+        if (hasThreadQueues_) {
+            // Records are popped under logMutex_, which is taken below once they are popped
+            std::vector<std::pair<std::shared_ptr<ThreadQueue>, size_t>> targets;
+            {
+                std::lock_guard<std::mutex> guard(threadQueuesMutex_);
+                for (const std::vector<std::shared_ptr<ThreadQueue>>& queues : shardQueues_)
+                    for (const std::shared_ptr<ThreadQueue>& queue : queues)
+                        targets.emplace_back(queue, queue->records.pushed());
+            }
+            for (const auto& [queue, target] : targets)
+                while (queue->records.popped() < target)
+                    std::this_thread::yield();
+        }
+
+        std::lock_guard<std::mutex> guard(logMutex_);
+        forEachSink([](tl::Sink& sink) { sink.flush(); });
+    }
+
+    /*
+     * @brief Adds a destination for the lines. By default, the logger only
+     *        has a ConsoleSink, that can be removed with clearSinks.
+     */
+    void addSink(std::shared_ptr<tl::Sink> sink) {
+        if (!sink)
+            return;
+
+        std::lock_guard<std::mutex> guard(logMutex_);
+        sinks_.push_back(std::move(sink));
+        sinkKinds_.store(kindsOf(sinks_), std::memory_order_relaxed);
+        publishCrashSinks();
+    }
+
+    // Flushes and removes the given sink, if it is used by this logger
+    void removeSink(const std::shared_ptr<tl::Sink>& sink) {
+        std::lock_guard<std::mutex> guard(logMutex_);
+
+        auto iterator = std::find(sinks_.begin(), sinks_.end(), sink);
+        if (iterator != sinks_.end()) {
+            (*iterator)->flush();
+            const std::shared_ptr<tl::Sink> removed = std::move(*iterator); // Kept until unpublished
+            sinks_.erase(iterator);
+            sinkKinds_.store(kindsOf(sinks_), std::memory_order_relaxed);
+            publishCrashSinks();
+        }
+    }
+
+    // Flushes and removes every sink, including the default console one
+    void clearSinks() {
+        std::lock_guard<std::mutex> guard(logMutex_);
+        for (const std::shared_ptr<tl::Sink>& sink : sinks_)
+            sink->flush();
+
+        std::vector<std::shared_ptr<tl::Sink>> removed; // Kept until unpublished
+        removed.swap(sinks_);
+        sinkKinds_.store(0, std::memory_order_relaxed);
+        publishCrashSinks();
+    }
+
+    /*
+     * @brief Returns the category with the given name, created on the first
+     *        call with the current level of the logger. The reference stays
+     *        valid as long as the logger.
+     *
+     * @note The lookup takes a lock: the TL_CATEGORY and LOG_*_CAT macros only
+     *       do it once per expansion.
+     */
+    tl::Category& category(std::string_view name) {
+        std::lock_guard<std::mutex> guard(logMutex_);
+
+        auto iterator = categories_.find(std::string(name));
+        if (iterator == categories_.end())
+            iterator = categories_.emplace(std::string(name), std::make_unique<tl::Category>(std::string(name), logLevel())).first;
+        return *iterator->second;
+    }
+
+    // Adds a sink to the category, which then stops writing to the logger sinks
+    void addSink(tl::Category& category, std::shared_ptr<tl::Sink> sink) {
+        if (!sink)
+            return;
+
+        std::lock_guard<std::mutex> guard(logMutex_);
+        if (!category.hasOwnSinks_) {
+            category.hasOwnSinks_ = true;
+            categoriesWithSinks_.push_back(&category);
+        }
+        category.sinks_.push_back(std::move(sink));
+        category.sinkKinds_.store(ownSinks | kindsOf(category.sinks_), std::memory_order_relaxed);
+        publishCrashSinks();
+    }
+
+    // Flushes and removes the given sink, if it is used by the category
+    void removeSink(tl::Category& category, const std::shared_ptr<tl::Sink>& sink) {
+        std::lock_guard<std::mutex> guard(logMutex_);
+
+        auto iterator = std::find(category.sinks_.begin(), category.sinks_.end(), sink);
+        if (iterator != category.sinks_.end()) {
+            (*iterator)->flush();
+            const std::shared_ptr<tl::Sink> removed = std::move(*iterator); // Kept until unpublished
+            category.sinks_.erase(iterator);
+            category.sinkKinds_.store(ownSinks | kindsOf(category.sinks_), std::memory_order_relaxed);
+            publishCrashSinks();
+        }
+    }
+
+    // Number of lines that exceeded the per-thread format buffer, see FormatBuffer
+    size_t formatHeapFallbacks() const {
+        return tl::detail::formatHeapFallbacks.load(std::memory_order_relaxed);
+    }
+
+    // Number of records discarded by the overflow policy since construction
+    size_t droppedRecords() const {
+        return droppedRecords_.load(std::memory_order_relaxed);
+    }
+
+    /*
+     * @brief Snapshot of the counters of the logger and of its sinks, see
+     *        tl::LoggerStats, and tl::prometheusText to export them.
+     *
+     * @note Producers only add to relaxed counters of their own stripe, and
+     *       time themselves when they wait, so the counters are always on.
+     */
+    tl::LoggerStats stats() const {
+        tl::LoggerStats stats;
+        uint64_t        blockedTicks = 0;
+        for (const tl::detail::StatsStripe& stripe : statsStripes_) {
+            for (size_t level = 0; level < stats.levels.size(); ++level) {
+                stats.levels[level].emitted    += stripe.emitted[level]   .load(std::memory_order_relaxed);
+                stats.levels[level].dropped    += stripe.dropped[level]   .load(std::memory_order_relaxed);
+                stats.levels[level].suppressed += stripe.suppressed[level].load(std::memory_order_relaxed);
+            }
+            blockedTicks             += stripe.blockedTicks      .load(std::memory_order_relaxed);
+            stats.arenaRecords       += stripe.arenaRecords      .load(std::memory_order_relaxed);
+            stats.arenaBlocked       += stripe.arenaBlocked      .load(std::memory_order_relaxed);
+            stats.arenaDropped       += stripe.arenaDropped      .load(std::memory_order_relaxed);
+            stats.arenaHeapFallbacks += stripe.arenaHeapFallbacks.load(std::memory_order_relaxed);
+        }
+        stats.blockedTime         = std::chrono::nanoseconds(tl::detail::TickClock::toNanoseconds(static_cast<int64_t>(blockedTicks)));
+        stats.queueHighWaterMark  = queueHighWaterMark_.load(std::memory_order_relaxed);
+        stats.formatLatency       = tl::detail::summarize(formatLatency_);
+        stats.writeLatency        = tl::detail::summarize(writeLatency_);
+        stats.formatHeapFallbacks = formatHeapFallbacks();
+
+        if (hasThreadQueues_) {
+            std::lock_guard<std::mutex> guard(threadQueuesMutex_);
+            for (const std::vector<std::shared_ptr<ThreadQueue>>& queues : shardQueues_) {
+                stats.threadQueues += queues.size();
+                if (!queues.empty())
+                    stats.queueCapacity = queues.front()->records.capacity();
+            }
+        }
+
+        std::lock_guard<std::mutex> guard(logMutex_);
+        if (asyncQueue_)
+            stats.queueCapacity = asyncQueue_->capacity();
+        forEachSink([&stats](const tl::Sink& sink) {
+            tl::SinkStats sinkStats;
+            sink.describeStats(sinkStats);
+            sinkStats.records = sink.writtenRecords();
+            sinkStats.bytes   = sink.writtenBytes();
+            stats.sinks.push_back(std::move(sinkStats));
+        });
+        return stats;
+    }
+
+    // Counts a call discarded by a rate-limited macro, see LoggerStats
+    void countSuppressed(const tl::CallSite& callSite) const {
+        statsStripe().suppressed[static_cast<size_t>(callSite.logLevel)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /*
+     * @brief Allocates what crashFlush needs, as it must not allocate. Called
+     *        by tl::installCrashHandler, before the handlers are installed.
+     */
+    void prepareCrashFlush() {
+        std::lock_guard<std::mutex> guard(logMutex_);
+        if (!crashState_) {
+            crashState_ = std::make_unique<CrashState>();
+            crashState_->buffer.bound(crashState_->spill);
+        }
+        publishCrashSinks();
+    }
+
+    /*
+     * @brief Writes what a crash would lose: the lines buffered by the sinks,
+     *        then the records left in the asynchronous queues, then reason as
+     *        a CRITICAL line. Called by the handler of tl::installCrashHandler.
+     *
+     * @note Async-signal-safe, and only does something once prepareCrashFlush
+     *       was called. Sinks and queues are reached without lock, since the
+     *       crashed thread may hold one, records are read where they wait,
+     *       and lines are rendered in a preallocated buffer, with UTC time.
+     *       A line that does not fit in the buffer is truncated.
+     */
+    void crashFlush(std::string_view reason) const {
+        CrashState* const state = crashState_.get();
+        if (!state)
+            return;
+
+        forEachCrashSink([](tl::Sink& sink, const tl::Category*) { sink.crashFlush(); });
+
+        tl::detail::FormatBuffer& buffer = state->buffer;
+        const auto writeRecord = [this, state, &buffer](const AsyncRecord& record) {
+            const LogLevel      logLevel = record.callSite->logLevel;
+            const tl::Category* category = record.callSite->category;
+            const tl::Category* owner    = category && category->hasOwnSinks_ ? category : nullptr;
+
+            buffer.clear();
+            appendCrashHeader(buffer, record.layout, logLevel, state->clockCalibration.toSystemTime(record.ticks), record.elapsed);
+            if (record.format)
+                record.format->decode(record.payloadData(), buffer);
+            else
+                buffer.append(record.text());
+            buffer.endLine();
+
+            forEachCrashSink([owner, logLevel, &buffer](tl::Sink& sink, const tl::Category* sinkCategory) {
+                if (sinkCategory == owner && !sink.isBinary() && sink.accepts(logLevel))
+                    sink.crashWrite(logLevel, buffer.view());
+            });
+        };
+
+        if (asyncQueue_)
+            while (asyncQueue_->tryVisit(writeRecord))
+                processedRecords_.fetch_add(1, std::memory_order_release);
+        if (hasThreadQueues_ && asyncSession_)
+            visitCrashThreadQueues(*asyncSession_, writeRecord);
+
+        buffer.clear();
+        appendCrashHeader(buffer, StructuredFormat::TEXT, LogLevel::CRITICAL, state->clockCalibration.toSystemTime(tl::detail::TickClock::now()), 0);
+        buffer.append(reason);
+        buffer.endLine();
+        forEachCrashSink([&buffer](tl::Sink& sink, const tl::Category*) {
+            if (!sink.isBinary() && sink.accepts(LogLevel::CRITICAL))
+                sink.crashWrite(LogLevel::CRITICAL, buffer.view());
+        });
+    }
+
+    /*
+     * @brief Changes the log level. It can be called while other threads are
+     *        logging: they will see the new level on their next call.
+     */
+    void setLogLevel(LogLevel logLevel) {
+        // Checks if the new log level is valid
+        #ifdef         MAX_LOG_LEVEL_AT_COMPILATION
+        if (static_cast<int>(logLevel) > MAX_LOG_LEVEL_AT_COMPILATION) {
+			logERROR("Invalid log level: ", static_cast<int>(logLevel), ". "
+                     "Maximum allowed is: ", MAX_LOG_LEVEL_AT_COMPILATION);
+            return;
+        }
+        #endif
+
+        // The level is published before the call sites are invalidated
+        logLevel_.store(logLevel, std::memory_order_relaxed);
+        tl::detail::levelGeneration.fetch_add(1, std::memory_order_release);
+    }
+
+    LogLevel logLevel() const {
+        return logLevel_.load(std::memory_order_relaxed);
+    }
+
+    /*
+     * @brief Applies levels given as text, see Runtime Configuration. It can
+     *        be called while other threads are logging, as setLogLevel.
+     *
+     * @return false, without changing any level, if an entry is invalid.
+     */
+    bool configure(std::string_view config) {
+        tl::detail::LevelConfig levels;
+        if (!tl::detail::parseLevelConfig(config, levels))
+            return false;
+
+        if (levels.logLevel)
+            setLogLevel(*levels.logLevel);
+        for (const auto& [name, logLevel] : levels.categories)
+            category(name).setLogLevel(logLevel);
+        return true;
+    }
+
+    // Applies the levels of the environment variable, if it is set, see configure
+    bool configureFromEnvironment(const char* variable = "TINYLOGGER_LEVEL") {
+        const char* config = std::getenv(variable);
+        return config && configure(config);
+    }
+
+    /*
+     * @brief Applies the levels of a file, see configure, then again on a
+     *        background thread every time it changes. Categories that are no
+     *        longer in the file get the level of the logger back. Watching
+     *        another file stops watching the previous one.
+     *
+     * @param path         File watched, which may not exist yet.
+     * @param pollInterval Time between two reads of the file, only used when
+     *                     the directory cannot be watched for changes.
+     */
+    void watchConfig(const std::filesystem::path& path, std::chrono::milliseconds pollInterval = std::chrono::seconds(1)) {
+        stopWatchingConfig();
+
+        // The first read is done by the caller, so that levels are set on return
+        std::string              content;
+        std::vector<std::string> categories;
+        const bool               isRead = tl::detail::readFile(path, content);
+        if (isRead)
+            applyConfigFile(path, content, categories);
+
+        configWatcher_ = std::make_unique<tl::detail::DirectoryWatcher>(std::filesystem::absolute(path).parent_path());
+        configThread_  = std::thread([this, path, pollInterval, isRead, content, categories]() mutable {
+            std::string applied = isRead ? content : std::string();
+            while (configWatcher_->wait(pollInterval))
+                if (tl::detail::readFile(path, content) && content != applied)
+                    applyConfigFile(path, applied = content, categories);
+        });
+    }
+
+    // Stops the thread started by watchConfig, keeping the levels it applied
+    void stopWatchingConfig() {
+        if (!configThread_.joinable())
+            return;
+
+        configWatcher_->stop();
+        configThread_.join();
+        configWatcher_.reset();
+    }
+
+    /*
+     * @brief Records the call sites disabled by the log level, up to the
+     *        given level, in a ring of every thread instead of dropping them.
+     *
+     * Records are kept raw, as in the asynchronous queue, and only the last
+     * capacity ones of a thread are. A LERROR or CRITICAL record writes the
+     * ring of its thread before itself, and dumpBacktrace writes every ring.
+     *
+     * @param capacity Number of records kept per thread, 0 to disable.
+     * @param logLevel Most verbose level that is recorded.
+     *
+     * @note Same caution as startAsync applies to this function.
+     */
+    void enableBacktrace(size_t capacity = 64, LogLevel logLevel = LogLevel::TRACE) {
+        disableBacktrace();
+        if (!capacity || logLevel == LogLevel::OFF)
+            return;
+
+        backtrace_ = std::make_shared<BacktraceSession>(capacity);
+        backtraceLevel_.store(logLevel, std::memory_order_relaxed);
+        tl::detail::levelGeneration.fetch_add(1, std::memory_order_release);
+    }
+
+    // Drops the recorded records, see enableBacktrace
+    void disableBacktrace() {
+        if (!backtrace_)
+            return;
+
+        backtraceLevel_.store(LogLevel::OFF, std::memory_order_relaxed);
+        tl::detail::levelGeneration.fetch_add(1, std::memory_order_release);
+
+        // Threads holding the session, and its rings, drop it on their next record
+        backtrace_->isClosed.store(true, std::memory_order_release);
+        backtrace_.reset();
+    }
+
+    /*
+     * @brief Writes the records of every ring, merged by timestamp, then
+     *        empties the rings. Elapsed times are the ones between the lines
+     *        of the dump. In the asynchronous mode, records are queued.
+     */
+    void dumpBacktrace() const {
+        if (!backtrace_)
+            return;
+
+        std::vector<AsyncRecord> records;
+        {
+            std::lock_guard<std::mutex> guard(backtrace_->mutex);
+            for (const std::shared_ptr<BacktraceRing>& ring : backtrace_->rings)
+                ring->take(records);
+
+            // Rings of the exited threads are kept until they are dumped
+            auto& rings = backtrace_->rings;
+            rings.erase(std::remove_if(rings.begin(), rings.end(), [](const std::shared_ptr<BacktraceRing>& ring) {
+                return ring->isReleased.load(std::memory_order_acquire);
+            }), rings.end());
+        }
+        writeBacktrace(records);
+    }
+
+    /*
+     * @brief Selects the layout and the precision of the printed timestamps.
+     *
+     * @param format    Layout of the date and time, see TimestampFormat.
+     * @param precision Number of sub-second digits, see TimestampPrecision.
+     */
+    void setTimestampFormat(TimestampFormat format, TimestampPrecision precision = TimestampPrecision::SECONDS) {
+        timestampFormat_   .store(format,    std::memory_order_relaxed);
+        timestampPrecision_.store(precision, std::memory_order_relaxed);
+    }
+
+    // Selects the record the elapsed time is measured from, see ElapsedScope
+    void setElapsedScope(ElapsedScope scope) {
+        elapsedScope_.store(scope, std::memory_order_relaxed);
+    }
+
+    // Selects the layout of the LOG_<LEVEL>_KV records, see StructuredFormat
+    void setStructuredFormat(StructuredFormat format) {
+        structuredFormat_.store(format, std::memory_order_relaxed);
+    }
+
+    StructuredFormat structuredFormat() const {
+        return structuredFormat_.load(std::memory_order_relaxed);
+    }
+
+    /*
+     * @brief Draws the progress of a loop, currentIteration being the index of
+     *        the iteration just done, from 0 to numberIterations - 1. It can be
+     *        called by the threads of a parallel loop: the bar shows the highest
+     *        index reported. Drawing is throttled, and never takes a lock in
+     *        the loop.
+     *
+     * @note Parallel loops, where indices are not done in order, are more
+     *       precisely tracked by a tl::ProgressBar, which counts the iterations.
+     */
+    void displayProgressBar(const size_t& currentIteration, const size_t& numberIterations) const {
+        // A new loop starts when the number of iterations changes, or with the first
+        // iteration after the last one. Only the thread winning the exchange resets
+        // the bar, as ProgressBar::reset must not run while other threads advance.
+        uint64_t   loop      = progressLoop_.load(std::memory_order_acquire);
+        const bool isNewLoop = numberIterations != (loop >> 1) ||
+                               (currentIteration == 0 && progressBar_.completed() >= progressBar_.total());
+        if (isNewLoop && !(loop & 1)) {
+            const uint64_t resetting = (static_cast<uint64_t>(numberIterations) << 1) | 1;
+            if (progressLoop_.compare_exchange_strong(loop, resetting, std::memory_order_acq_rel)) {
+                progressBar_.reset(numberIterations);
+                loop = resetting & ~uint64_t(1);
+                progressLoop_.store(loop, std::memory_order_release);
+            }
+        }
+
+        // Reports made while another thread resets the bar are dropped
+        if (!(loop & 1))
+            progressBar_.update(currentIteration + 1);
+    }
+
+    /*
+     * @brief Starts measuring the time until releaseFlag is called with the
+     *        same name, from any place of the program.
+     *
+     * @note Flags are looked up by name under a lock: hot sections are better
+     *       measured by TL_SCOPED_TIMER, see reportTimers.
+     */
+    void addFlag(const std::string& flagName) const {
+		// Locks mutex for thread-safety flag addition
+        std::lock_guard<std::mutex> guard(flagMutex_);
+
+        // Flag may already exist, and will be overwritten
+        if (flagTimes_.find(flagName) != flagTimes_.end())
+			logWARNING("Flag '", flagName, "' already exists and will be overwritten.");
+
+        // Saving the current time for the flag in the flags map
+        flagTimes_[flagName] = std::chrono::steady_clock::now();
+    }
+
+    void releaseFlag(const std::string& flagName) const {
+        // Locks mutex for thread-safety flag removal
+        std::lock_guard<std::mutex> guard(flagMutex_);
+
+        auto iterator  = flagTimes_.find(flagName);
+        if  (iterator == flagTimes_.end())
+			logERROR("Flag '", flagName, "' could not be found in memory.");
+        else {
+            const auto elapsedTimeFlag = std::chrono::steady_clock::now() - iterator->second;
+            const auto nanoseconds     = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsedTimeFlag).count();
+
+			logINFO("Flag '", flagName, "' released after ", tl::detail::formatDuration(static_cast<uint64_t>(nanoseconds)), '.');
+        }
+    }
+
+    /*
+     * @brief Logs one INFO line per timer site with samples recorded since the
+     *        previous report, merging the histograms of all the threads:
+     *          Timer 'parse': count=1200 p50=1.250 us p99=3.875 us p999=7.750 us max=8.012 us
+     *        Percentiles are the highest value of their bucket, so within 7%.
+     *        Called by the scoped timers every report interval, and can also
+     *        be called directly, for instance before exiting.
+     */
+    void reportTimers() const {
+        using tl::detail::TimerHistogram;
+
+        std::vector<std::string> lines;
+        {
+            tl::detail::TimerRegistry&  registry = tl::detail::timerRegistry();
+            std::lock_guard<std::mutex> guard(registry.mutex);
+
+            for (tl::TimerSite* site : registry.sites) {
+                TimerHistogram::Counts counts  = site->retired_;
+                uint64_t               maximum = std::exchange(site->retiredMaximum_, 0);
+                for (const tl::detail::ThreadTimers* threadTimers : registry.threads) {
+                    if (TimerHistogram* histogram = threadTimers->find(site->index_)) {
+                        histogram->addTo(counts);
+                        maximum = std::max(maximum, histogram->takeMaximum());
+                    }
+                }
+
+                // Only the samples recorded since the previous report are kept
+                uint64_t count = 0;
+                for (size_t i = 0; i < TimerHistogram::bucketCount; ++i) {
+                    const uint64_t total = counts[i];
+                    counts[i]          -= site->reported_[i];
+                    site->reported_[i]  = total;
+                    count              += counts[i];
+                }
+                if (!count)
+                    continue;
+
+                const auto percentile = [&counts, count, maximum](double rank) {
+                    const uint64_t value = TimerHistogram::percentileOf(counts, count, rank);
+                    return tl::detail::formatDuration(maximum ? std::min(value, maximum) : value);
+                };
+
+                lines.push_back("Timer '" + site->name_ + "': count=" + std::to_string(count)
+                              + " p50="  + percentile(0.50)
+                              + " p99="  + percentile(0.99)
+                              + " p999=" + percentile(0.999)
+                              + " max="  + percentile(1.0));
+            }
+        }
+
+        // Logged once the registry is released, since sinks may take a while
+        for (const std::string& line : lines)
+            logINFO(line);
+    }
+
+    /*
+     * @brief Sets how often the scoped timers report their histograms, see
+     *        reportTimers. Ten seconds by default, zero disables the reports.
+     */
+    void setTimerReportInterval(std::chrono::nanoseconds interval) {
+        const int64_t ticks = static_cast<int64_t>(static_cast<double>(interval.count()) / tl::detail::TickClock::nanosecondsPerTick());
+        timerReportInterval_.store(ticks, std::memory_order_relaxed);
+        nextTimerReport_    .store(tl::detail::TickClock::now() + static_cast<uint64_t>(ticks), std::memory_order_relaxed);
+    }
+
+    // Called by every ScopedTimer, a single thread reporting once the interval is elapsed
+    void reportTimersIfDue(uint64_t ticks) const {
+        uint64_t nextTimerReport = nextTimerReport_.load(std::memory_order_relaxed);
+        if (ticks < nextTimerReport)
+            return;
+
+        const int64_t interval = timerReportInterval_.load(std::memory_order_relaxed);
+        if (interval > 0 && nextTimerReport_.compare_exchange_strong(nextTimerReport, ticks + static_cast<uint64_t>(interval), std::memory_order_relaxed))
+            reportTimers();
+    }
+
+private:
+    /*
+     * Record pushed by producers and consumed by the backend thread. When all
+     * the arguments are deferrable, their raw copy is stored in the payload
+     * and format renders them on the backend. Otherwise, the message is
+     * formatted by the producer and stored as a string. With an arena, the
+     * payload too large for the record, or the message, is in a slab.
+     */
+    struct AsyncRecord {
+        const tl::CallSite*                   callSite  = nullptr;
+        uint64_t                              ticks     = 0;
+        int64_t                               elapsed   = 0;
+        const tl::detail::PayloadFormat*      format    = nullptr;
+        StructuredFormat                      layout    = StructuredFormat::TEXT;
+        std::string                           message;
+        tl::detail::ArenaSlab*                slab      = nullptr;
+        const char*                           arenaData = nullptr;
+        size_t                                arenaSize = 0;
+        char                                  payload[TINYLOGGER_PAYLOAD_SIZE];
+
+        const char* payloadData() const {
+            return slab ? arenaData : payload;
+        }
+
+        std::string_view text() const {
+            return slab ? std::string_view(arenaData, arenaSize) : std::string_view(message);
+        }
+    };
+
+    // Queue of a single producer thread, see AsyncOptions::threadQueues
+    struct ThreadQueue {
+        ThreadQueue(size_t capacity, size_t shard) : records(capacity), shard(shard) {}
+
+        tl::detail::SpscQueue<AsyncRecord> records;
+        const size_t                       shard;
+        std::atomic<bool>                  isReleased{ false }; // Its thread exited
+    };
+
+    // Readers of the thread queues of a shard, which only has one at a time
+    enum class ShardReader { NONE, BACKEND, CRASH };
+
+    // Thread queues drained on a crash, beyond which the records of the other threads are lost
+    static constexpr size_t maxCrashThreadQueues = 256;
+
+    // State of an asynchronous session, which the threads that logged may outlive
+    struct AsyncSession {
+        std::atomic<bool>                        isClosed{ false };
+        std::unique_ptr<tl::detail::RecordArena> arena;
+
+        // The crash handler reaches the thread queues without threadQueuesMutex_
+        std::array<std::atomic<ThreadQueue*>, maxCrashThreadQueues> crashQueues{};
+        std::unique_ptr<std::atomic<ShardReader>[]>                 shardReaders;
+    };
+
+    // Queue and slab of a thread for a session, released when the thread exits
+    struct ThreadState {
+        explicit ThreadState(std::shared_ptr<AsyncSession> session)
+            : session(std::move(session)), arena(this->session->arena.get()) {}
+
+        ~ThreadState() {
+            if (queue)
+                queue->isReleased.store(true, std::memory_order_release);
+        }
+
+        // Destroyed after the cursor, which retires its slab to the arena of the session
+        std::shared_ptr<AsyncSession> session;
+        std::shared_ptr<ThreadQueue>  queue;
+        tl::detail::ArenaCursor       arena;
+    };
+
+    /*
+     * Last records of a thread, see enableBacktrace. The slot at next is out
+     * of the ring, so the thread writes it without lock before publishing it,
+     * and the lock is only contended while the ring is dumped.
+     */
+    struct BacktraceRing {
+        explicit BacktraceRing(size_t capacity) : records(capacity + 1) {}
+
+        AsyncRecord& slot() {
+            return records[next];
+        }
+
+        void publish() {
+            std::lock_guard<std::mutex> guard(mutex);
+            next = next + 1 < records.size() ? next + 1 : 0;
+            size = std::min(size + 1, records.size() - 1);
+        }
+
+        // Moves the records out, from the oldest one, and empties the ring
+        void take(std::vector<AsyncRecord>& output) {
+            std::lock_guard<std::mutex> guard(mutex);
+            for (size_t i = records.size() - size; i < records.size(); ++i)
+                output.push_back(std::move(records[(next + i) % records.size()]));
+            size = 0;
+        }
+
+        std::vector<AsyncRecord> records;
+        size_t                   next = 0;
+        size_t                   size = 0;
+        std::mutex               mutex;
+        std::atomic<bool>        isReleased{ false }; // Its thread exited
+    };
+
+    // Rings of the threads that recorded, which may outlive disableBacktrace
+    struct BacktraceSession {
+        explicit BacktraceSession(size_t capacity) : capacity(capacity) {}
+
+        const size_t                                capacity;
+        std::atomic<bool>                           isClosed{ false };
+        std::mutex                                  mutex;
+        std::vector<std::shared_ptr<BacktraceRing>> rings;
+    };
+
+    // Ring of a thread for a session, released when the thread exits
+    struct BacktraceHandle {
+        explicit BacktraceHandle(std::shared_ptr<BacktraceSession> session)
+            : session(std::move(session)), ring(std::make_shared<BacktraceRing>(this->session->capacity)) {}
+
+        ~BacktraceHandle() {
+            ring->isReleased.store(true, std::memory_order_release);
+        }
+
+        std::shared_ptr<BacktraceSession> session;
+        std::shared_ptr<BacktraceRing>    ring;
+    };
+
+    // Where storeInArena put a record
+    enum class ArenaOutcome {
+        STORED,
+        HEAP,
+        DROPPED
+    };
+
+    // Kinds of sinks accepting a record, as returned by acceptingSinks
+    static constexpr unsigned textSinks   = 1;
+    static constexpr unsigned binarySinks = 2;
+
+    // Set in the kinds of a category writing to its own sinks
+    static constexpr unsigned ownSinks    = 4;
+
+    // Logs at the level of the logging functions, see levelCallSite
+    template <typename... Args>
+    INLINING_TINYLOGGER void logLevelDirect(LogLevel logLevel, Args&&... args) const {
+        const tl::detail::ArgumentTuple<Args...> arguments(args...);
+        emit(tl::detail::levelCallSite(logLevel), tl::detail::packArguments<Args...>(arguments));
+    }
+
+    // Writes the record, or queues it in the asynchronous mode, see logPacked
+    void emit(const tl::CallSite& callSite, const tl::detail::ArgumentPack& pack) const;
+
+    // Packs the arguments for the binary sinks, since there is no record yet
+    void emitBinary(const std::vector<std::shared_ptr<tl::Sink>>& sinks, const tl::CallSite& callSite,
+                    std::chrono::system_clock::time_point time, const tl::detail::ArgumentPack& pack) const {
+        char             payload[TINYLOGGER_PAYLOAD_SIZE];
+        std::string      message;
+        tl::RecordView   record{ &callSite, time, nullptr, payload, std::string_view() };
+
+        char* cursor = payload;
+        if (pack.format->payloadFormat && pack.format->encode(pack.arguments, cursor, payload + sizeof(payload)))
+            record.format = pack.format->payloadFormat;
+        if (!record.format) {
+            tl::detail::FormatBuffer& buffer = tl::detail::threadFormatBuffer();
+            buffer.clear();
+            pack.format->appendBinary(pack.arguments, buffer);
+            message        = std::string(buffer.view());
+            record.message = message;
+        }
+
+        dispatchBinary(sinks, record);
+    }
+
+    void formatLine(tl::detail::FormatBuffer& buffer, LogLevel logLevel,
+                    std::chrono::system_clock::time_point time, int64_t elapsed, const tl::detail::ArgumentPack& pack) const {
+        buffer.clear();
+        appendHeader(buffer, pack.format->layout(pack.arguments), logLevel, time, elapsed);
+        pack.format->append(pack.arguments, buffer);
+        buffer.append('\n');
+    }
+
+    /*
+     * @brief Microseconds since the previous record of the thread, or of the
+     *        category of the call site, according to the ElapsedScope. The
+     *        ticks of the record replace the previous ones.
+     */
+    int64_t elapsedOf(const tl::CallSite& callSite, uint64_t ticks) const {
+        uint64_t lastLogTime;
+        if (elapsedScope_.load(std::memory_order_relaxed) == ElapsedScope::CATEGORY) {
+            std::atomic<uint64_t>& categoryLastLogTime = callSite.category ? callSite.category->lastLogTime_ : lastLogTime_;
+            lastLogTime = categoryLastLogTime.exchange(ticks, std::memory_order_relaxed);
+        }
+        else
+            lastLogTime = std::exchange(tl::detail::threadLastLogTime(), ticks);
+
+        return lastLogTime ? tl::detail::TickClock::toNanoseconds(static_cast<int64_t>(ticks - lastLogTime)) / 1000 : 0;
+    }
+
+    // Level the call site is compared to, the one of its category if any
+    LogLevel levelOf(const tl::CallSite& callSite) const {
+        return callSite.category ? callSite.category->logLevel() : logLevel_.load(std::memory_order_relaxed);
+    }
+
+    // Applies a version of the watched file, categories holding the ones of the previous version
+    void applyConfigFile(const std::filesystem::path& path, std::string_view content, std::vector<std::string>& categories) {
+        tl::detail::LevelConfig levels;
+        if (!tl::detail::parseLevelConfig(content, levels)) {
+            logWARNING("Invalid log levels in ", path.string(), ", the file is ignored until it changes");
+            return;
+        }
+
+        if (levels.logLevel)
+            setLogLevel(*levels.logLevel);
+        for (const std::string& name : categories)
+            if (std::none_of(levels.categories.begin(), levels.categories.end(), [&name](const auto& entry) { return entry.first == name; }))
+                category(name).setLogLevel(logLevel());
+
+        categories.clear();
+        for (const auto& [name, logLevel] : levels.categories) {
+            category(name).setLogLevel(logLevel);
+            categories.push_back(name);
+        }
+    }
+
+    // Level up to which the call site is either logged or recorded, see enableBacktrace
+    LogLevel thresholdOf(const tl::CallSite& callSite) const {
+        return std::max(levelOf(callSite), backtraceLevel_.load(std::memory_order_relaxed));
+    }
+
+    // Tells whether the call site is disabled by the log level, but recorded
+    bool isBacktraced(const tl::CallSite& callSite) const {
+        return callSite.logLevel <= backtraceLevel_.load(std::memory_order_relaxed) && callSite.logLevel > levelOf(callSite);
+    }
+
+    // Stores the record in the ring of the thread, formatted only if it cannot be deferred
+    void recordBacktrace(const tl::CallSite& callSite, const tl::detail::ArgumentPack& pack) const {
+        BacktraceRing& ring   = *backtraceHandle().ring;
+        AsyncRecord&   record = ring.slot();
+        record.callSite = &callSite;
+        record.ticks    = tl::detail::TickClock::now();
+        record.layout   = pack.format->layout(pack.arguments);
+        record.format   = nullptr;
+
+        char* cursor = record.payload;
+        if (pack.format->payloadFormat && pack.format->encode(pack.arguments, cursor, record.payload + sizeof(record.payload)))
+            record.format = pack.format->payloadFormat;
+        else
+            record.message.assign(formatArguments(pack));
+
+        ring.publish();
+    }
+
+    // Ring of the calling thread for the current backtrace, created on its first record
+    BacktraceHandle& backtraceHandle() const {
+        thread_local std::vector<std::unique_ptr<BacktraceHandle>> handles;
+        for (const std::unique_ptr<BacktraceHandle>& handle : handles)
+            if (handle->session == backtrace_)
+                return *handle;
+
+        // Handles of the disabled backtraces, of this logger or another one, are dropped
+        handles.erase(std::remove_if(handles.begin(), handles.end(), [](const std::unique_ptr<BacktraceHandle>& handle) {
+            return handle->session->isClosed.load(std::memory_order_acquire);
+        }), handles.end());
+
+        auto handle = std::make_unique<BacktraceHandle>(backtrace_);
+        {
+            std::lock_guard<std::mutex> guard(backtrace_->mutex);
+            backtrace_->rings.push_back(handle->ring);
+        }
+
+        handles.push_back(std::move(handle));
+        return *handles.back();
+    }
+
+    // Called before a LERROR or CRITICAL record, with the ring of its thread only
+    void dumpThreadBacktrace() const {
+        std::vector<AsyncRecord> records;
+        backtraceHandle().ring->take(records);
+        writeBacktrace(records);
+    }
+
+    // Writes the records taken from the rings, or queues them in the asynchronous mode
+    void writeBacktrace(std::vector<AsyncRecord>& records) const {
+        if (records.empty())
+            return;
+
+        std::stable_sort(records.begin(), records.end(), [](const AsyncRecord& left, const AsyncRecord& right) {
+            return left.ticks < right.ticks;
+        });
+        for (size_t i = 0; i < records.size(); ++i)
+            records[i].elapsed = i ? tl::detail::TickClock::toNanoseconds(static_cast<int64_t>(records[i].ticks - records[i - 1].ticks)) / 1000 : 0;
+
+        if (isAsync()) {
+            for (AsyncRecord& record : records)
+                enqueue(std::move(record));
+            return;
+        }
+
+        tl::detail::FormatBuffer&     buffer           = tl::detail::threadFormatBuffer();
+        tl::detail::ClockCalibration& clockCalibration = tl::detail::threadClockCalibration();
+
+        std::lock_guard<std::mutex> guard(logMutex_);
+        for (const AsyncRecord& record : records) {
+            const LogLevel                                logLevel = record.callSite->logLevel;
+            const std::vector<std::shared_ptr<tl::Sink>>& sinks    = sinksOf(*record.callSite);
+            const unsigned                                accepted = acceptingSinks(sinks, logLevel);
+            const std::chrono::system_clock::time_point   time     = clockCalibration.toSystemTime(record.ticks);
+
+            if (accepted & binarySinks)
+                dispatchBinary(sinks, tl::RecordView{ record.callSite, time, record.format, record.payloadData(), record.text() });
+            if (accepted & textSinks) {
+                renderRecord(buffer, record, time);
+                dispatch(sinks, logLevel, buffer.view());
+            }
+        }
+        forEachSink([](tl::Sink& sink) { sink.endBatch(); });
+    }
+
+    // Sinks receiving the records of the call site, must be called under logMutex_
+    const std::vector<std::shared_ptr<tl::Sink>>& sinksOf(const tl::CallSite& callSite) const {
+        if (callSite.category && callSite.category->hasOwnSinks_)
+            return callSite.category->sinks_;
+        return sinks_;
+    }
+
+    // Calls function on the sinks of the logger and of its categories, under logMutex_
+    template <typename Function>
+    void forEachSink(Function&& function) const {
+        for (const std::shared_ptr<tl::Sink>& sink : sinks_)
+            function(*sink);
+        for (const tl::Category* category : categoriesWithSinks_)
+            for (const std::shared_ptr<tl::Sink>& sink : category->sinks_)
+                function(*sink);
+    }
+
+    /*
+     * Copies the sinks to the table read by crashFlush, under logMutex_ and
+     * before a removed sink is released. Sinks beyond the table are not
+     * written on a crash.
+     */
+    void publishCrashSinks() {
+        size_t count = 0;
+        const auto publish = [this, &count](const std::vector<std::shared_ptr<tl::Sink>>& sinks, const tl::Category* category) {
+            for (const std::shared_ptr<tl::Sink>& sink : sinks) {
+                if (count == maxCrashSinks)
+                    return;
+                crashSinks_[count].sink    .store(sink.get(), std::memory_order_relaxed);
+                crashSinks_[count].category.store(category,   std::memory_order_relaxed);
+                ++count;
+            }
+        };
+
+        publish(sinks_, nullptr);
+        for (const tl::Category* category : categoriesWithSinks_)
+            publish(category->sinks_, category);
+        crashSinkCount_.store(count, std::memory_order_release);
+    }
+
+    // Calls function on the published sinks, with their category, see publishCrashSinks
+    template <typename Function>
+    void forEachCrashSink(Function&& function) const {
+        const size_t count = crashSinkCount_.load(std::memory_order_acquire);
+        for (size_t i = 0; i < count; ++i)
+            function(*crashSinks_[i].sink.load(std::memory_order_relaxed), crashSinks_[i].category.load(std::memory_order_relaxed));
+    }
+
+    /*
+     * Calls function on the records of the thread queues, merged by time as
+     * popOldest does. The backend reads the queues of a shard batch by batch,
+     * and the first batch to end in time hands them over to the crash handler.
+     */
+    template <typename Function>
+    void visitCrashThreadQueues(AsyncSession& session, Function&& function) const {
+        const size_t                                shardCount = shardQueues_.size();
+        const std::chrono::steady_clock::time_point deadline   = std::chrono::steady_clock::now() + std::chrono::milliseconds(100);
+        for (size_t shard = 0; shard < shardCount; ++shard) {
+            ShardReader idle = ShardReader::NONE;
+            while (!session.shardReaders[shard].compare_exchange_weak(idle, ShardReader::CRASH, std::memory_order_acquire) &&
+                   std::chrono::steady_clock::now() < deadline)
+                idle = ShardReader::NONE;
+        }
+
+        for (;;) {
+            ThreadQueue*       oldestQueue  = nullptr;
+            const AsyncRecord* oldestRecord = nullptr;
+            for (const std::atomic<ThreadQueue*>& slot : session.crashQueues) {
+                ThreadQueue* queue = slot.load(std::memory_order_acquire);
+                if (!queue || session.shardReaders[queue->shard].load(std::memory_order_relaxed) != ShardReader::CRASH)
+                    continue;
+
+                const AsyncRecord* front = queue->records.front();
+                if (front && (!oldestRecord || front->ticks < oldestRecord->ticks)) {
+                    oldestQueue  = queue;
+                    oldestRecord = front;
+                }
             }
+            if (!oldestQueue)
+                break;
+
+            // Left in its slot, for the producer to replace
+            function(*oldestRecord);
+            oldestQueue->records.pop();
         }
-    }
 
-    template <typename... Args>
-    INLINING_TINYLOGGER void logTRACE(Args&&... args) const {
-        // Locks mutex during log for thread-safety
-        std::lock_guard<std::mutex> guard(logMutex_);
-        std::clog << "[TRACE]    " << formatMessage(std::forward<Args>(args)...) << std::endl;
+        // The backend reads the queues again if the process goes on
+        for (size_t shard = 0; shard < shardCount; ++shard)
+            if (session.shardReaders[shard].load(std::memory_order_relaxed) == ShardReader::CRASH)
+                session.shardReaders[shard].store(ShardReader::NONE, std::memory_order_release);
     }
 
-    template <typename... Args>
-    INLINING_TINYLOGGER void logDEBUG(Args&&... args) const {
-        // Locks mutex during log for thread-safety
-        std::lock_guard<std::mutex> guard(logMutex_);
-        std::clog << "[DEBUG]    " << formatMessage(std::forward<Args>(args)...) << std::endl;
+    // Kinds of the sinks of the call site, read without lock and maybe outdated
+    unsigned sinkKindsOf(const tl::CallSite& callSite) const {
+        if (callSite.category) {
+            const unsigned kinds = callSite.category->sinkKinds_.load(std::memory_order_relaxed);
+            if (kinds & ownSinks)
+                return kinds;
+        }
+        return sinkKinds_.load(std::memory_order_relaxed);
     }
 
-    template <typename... Args>
-    INLINING_TINYLOGGER void logVERBOSE(Args&&... args) const {
-        // Locks mutex during log for thread-safety
-        std::lock_guard<std::mutex> guard(logMutex_);
-        std::clog << "[VERBOSE]  " << formatMessage(std::forward<Args>(args)...) << std::endl;
+    static unsigned kindsOf(const std::vector<std::shared_ptr<tl::Sink>>& sinks) {
+        unsigned kinds = 0;
+        for (const std::shared_ptr<tl::Sink>& sink : sinks)
+            kinds |= sink->isBinary() ? binarySinks : textSinks;
+        return kinds;
     }
 
-    template <typename... Args>
-    INLINING_TINYLOGGER void logINFO(Args&&... args) const {
-        // Locks mutex during log for thread-safety
-        std::lock_guard<std::mutex> guard(logMutex_);
-        std::cout <<"[INFO]     " << formatMessage(std::forward<Args>(args)...) << std::endl;
+    // Must be called under logMutex_, as every function reading sinks_
+    static unsigned acceptingSinks(const std::vector<std::shared_ptr<tl::Sink>>& sinks, LogLevel logLevel) {
+        unsigned accepted = 0;
+        for (const std::shared_ptr<tl::Sink>& sink : sinks)
+            if (sink->accepts(logLevel))
+                accepted |= sink->isBinary() ? binarySinks : textSinks;
+        return accepted;
     }
 
-    template <typename... Args>
-    INLINING_TINYLOGGER void logWARNING(Args&&... args) const {
-        // Locks mutex during log for thread-safety
-        std::lock_guard<std::mutex> guard(logMutex_);
-        std::clog << "[WARNING]  " << formatMessage(std::forward<Args>(args)...) << std::endl;
+    // Hands the line, formatted once, to every text sink accepting its level
+    static void dispatch(const std::vector<std::shared_ptr<tl::Sink>>& sinks, LogLevel logLevel, std::string_view line) {
+        for (const std::shared_ptr<tl::Sink>& sink : sinks)
+            if (!sink->isBinary() && sink->accepts(logLevel)) {
+                sink->countWrite(line.size());
+                sink->write(logLevel, line);
+            }
     }
 
-    template <typename... Args>
-    INLINING_TINYLOGGER void logERROR(Args&&... args) const {
-        // Locks mutex during log for thread-safety
-        std::lock_guard<std::mutex> guard(logMutex_);
-        std::cerr << "[ERROR]    " << formatMessage(std::forward<Args>(args)...) << std::endl;
+    static void dispatchBinary(const std::vector<std::shared_ptr<tl::Sink>>& sinks, const tl::RecordView& record) {
+        for (const std::shared_ptr<tl::Sink>& sink : sinks)
+            if (sink->isBinary() && sink->accepts(record.callSite->logLevel)) {
+                sink->countWrite(0);
+                sink->writeRecord(record);
+            }
     }
 
-    template <typename... Args>
-    [[noreturn]] INLINING_TINYLOGGER void logCRITICAL(Args&&... args) const {
-        // Locks mutex during log for thread-safety
-        std::lock_guard<std::mutex> guard(logMutex_);
-		std::cerr << "[CRITICAL] " << formatMessage(std::forward<Args>(args)...) << std::endl;
+    // Called after a CRITICAL record, that must reach the disk before exiting
+    [[noreturn]] void terminate() const {
+        flush();
+        {
+            std::lock_guard<std::mutex> guard(logMutex_);
+            forEachSink([](tl::Sink& sink) { sink.sync(); });
+        }
         exit(EXIT_FAILURE);
     }
 
-    void setLogLevel(LogLevel logLevel) {
-        // Locks mutex when logLevel update for safety
-		std::lock_guard<std::mutex> guard(logMutex_);
+    bool isAsync() const {
+        return asyncQueue_ || hasThreadQueues_;
+    }
 
-        // Checks if the new log level is valid
-        #ifdef         MAX_LOG_LEVEL_AT_COMPILATION
-        if (logLevel > MAX_LOG_LEVEL_AT_COMPILATION) {
-			logERROR("Invalid log level: ", static_cast<int>(logLevel), ". "
-                     "Maximum allowed is: ", MAX_LOG_LEVEL_AT_COMPILATION);
+    void enqueue(AsyncRecord&& record) const {
+        // Tick of the first failed push, when the producer has to wait
+        uint64_t waitStart = 0;
+
+        if (hasThreadQueues_) {
+            ThreadQueue& queue = *threadState().queue;
+            while (!queue.records.tryPush(std::move(record))) {
+                if (asyncOptions_.overflowPolicy != OverflowPolicy::BLOCK) {
+                    discard(record);
+                    return;
+                }
+                if (!waitStart)
+                    waitStart = tl::detail::TickClock::now();
+                std::this_thread::yield();
+            }
+            if (waitStart)
+                statsStripe().blockedTicks.fetch_add(tl::detail::TickClock::now() - waitStart, std::memory_order_relaxed);
             return;
         }
-        #endif
 
-        logLevel_ = logLevel;
+        for (;;) {
+            if (asyncQueue_->tryPush(std::move(record))) {
+                enqueuedRecords_.fetch_add(1, std::memory_order_release);
+                if (waitStart)
+                    statsStripe().blockedTicks.fetch_add(tl::detail::TickClock::now() - waitStart, std::memory_order_relaxed);
+                return;
+            }
+
+            switch (asyncOptions_.overflowPolicy) {
+                case OverflowPolicy::DROP_NEWEST:
+                    discard(record);
+                    return;
+                case OverflowPolicy::DROP_OLDEST: {
+                    AsyncRecord evictedRecord;
+                    if (asyncQueue_->tryPop(evictedRecord)) {
+                        discard(evictedRecord);
+                        processedRecords_.fetch_add(1, std::memory_order_release);
+                    }
+                    break;
+                }
+                default: // OverflowPolicy::BLOCK
+                    if (!waitStart)
+                        waitStart = tl::detail::TickClock::now();
+                    std::this_thread::yield();
+                    break;
+            }
+        }
     }
 
-    void displayProgressBar(const size_t& currentIteration, const size_t& numberIterations) const {
-        // Locks the mutex for thread-safety display
-        std::lock_guard<std::mutex> guard(logMutex_);
+    void countDropped(const tl::CallSite& callSite) const {
+        droppedRecords_.fetch_add(1, std::memory_order_relaxed);
+        statsStripe().dropped[static_cast<size_t>(callSite.logLevel)].fetch_add(1, std::memory_order_relaxed);
+    }
 
-		// Progress bar width parameter (in characters)
-        static const size_t progressBarWidth = 50;
+    // Drops a record that will not be written, with its arena allocation
+    void discard(const AsyncRecord& record) const {
+        countDropped(*record.callSite);
+        if (record.slab)
+            arena_->release(record.slab);
+    }
 
-		double oldProgressPercentage = (static_cast<double>(currentIteration_.load()) / (numberIterations_.load() - 1)) * 100.0;
-		double newProgressPercentage = (static_cast<double>(currentIteration)         / (numberIterations - 1))         * 100.0;
+    /*
+     * @brief Stores a record in the slab of the thread, encode writing it
+     *        from a cursor it advances, up to an end. Runs out of slabs as
+     *        set by AsyncOptions::arenaPolicy, a record larger than a slab
+     *        going to the heap too.
+     */
+    template <typename Encode>
+    ArenaOutcome storeInArena(AsyncRecord& record, Encode&& encode) const {
+        tl::detail::ArenaCursor& arena     = threadState().arena;
+        tl::detail::StatsStripe& stripe    = statsStripe();
+        uint64_t                 waitStart = 0;
 
-        // Progress bar is refreshed every new percentage value or for a new initialisation
-        bool isLastIteration = (currentIteration == numberIterations - 1);
-        if ((newProgressPercentage - oldProgressPercentage < 1) &&
-            (numberIterations == numberIterations_.load())      &&
-            (!isLastIteration))
-            return;
+        for (bool isSlabEmpty = false;;) {
+            char* cursor = arena.begin();
+            if (cursor && encode(cursor, arena.end())) {
+                record.arenaData = arena.begin();
+                record.arenaSize = static_cast<size_t>(cursor - record.arenaData);
+                record.slab      = arena.commit(cursor);
+                stripe.arenaRecords.fetch_add(1, std::memory_order_relaxed);
+                if (waitStart)
+                    stripe.blockedTicks.fetch_add(tl::detail::TickClock::now() - waitStart, std::memory_order_relaxed);
+                return ArenaOutcome::STORED;
+            }
+            if (isSlabEmpty) {
+                stripe.arenaHeapFallbacks.fetch_add(1, std::memory_order_relaxed);
+                return ArenaOutcome::HEAP;
+            }
+            if (arena.renew()) {
+                isSlabEmpty = true;
+                continue;
+            }
 
-        // Updating internal logging parameters
-		currentIteration_.store(currentIteration);
-        numberIterations_.store(numberIterations);
-        
-        size_t filledWidth = static_cast<size_t>(progressBarWidth * (newProgressPercentage / 100.0));
-        std::string progressBar = "           [" 
-                                  + std::string(filledWidth, '=') 
-                                  + std::string(progressBarWidth - filledWidth, ' ')
-                                  + "] ";
+            switch (asyncOptions_.arenaPolicy) {
+                case ArenaPolicy::DROP:
+                    stripe.arenaDropped.fetch_add(1, std::memory_order_relaxed);
+                    countDropped(*record.callSite);
+                    return ArenaOutcome::DROPPED;
+                case ArenaPolicy::BLOCK:
+                    if (!waitStart) {
+                        waitStart = tl::detail::TickClock::now();
+                        stripe.arenaBlocked.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    std::this_thread::yield();
+                    break;
+                default: // ArenaPolicy::HEAP
+                    stripe.arenaHeapFallbacks.fetch_add(1, std::memory_order_relaxed);
+                    return ArenaOutcome::HEAP;
+            }
+        }
+    }
 
-        // Displays the progress bar with percentage
-        std::cout << progressBar << std::fixed << std::setprecision(0) << static_cast<int>(newProgressPercentage) << "%\r";
-		std::cout.flush();
+    tl::detail::StatsStripe& statsStripe() const {
+        return statsStripes_[tl::detail::threadStripe() % statsStripes_.size()];
     }
 
-    void addFlag(const std::string& flagName) const {
-		// Locks mutex for thread-safety flag addition
-        std::lock_guard<std::mutex> guard(flagMutex_);
+    // State of the calling thread for the running session, created on its first record
+    ThreadState& threadState() const {
+        thread_local std::vector<std::unique_ptr<ThreadState>> states;
+        for (const std::unique_ptr<ThreadState>& state : states)
+            if (state->session == asyncSession_)
+                return *state;
 
-        // Flag may already exist, and will be overwritten
-        if (flagTimes_.find(flagName) != flagTimes_.end())
-			logWARNING("Flag '", flagName, "' already exists and will be overwritten.");
+        // States of the stopped sessions, of this logger or another one, are dropped
+        states.erase(std::remove_if(states.begin(), states.end(), [](const std::unique_ptr<ThreadState>& state) {
+            return state->session->isClosed.load(std::memory_order_acquire);
+        }), states.end());
 
-        // Saving the current time for the flag in the flags map
-        flagTimes_[flagName] = std::chrono::system_clock::now();
+        auto state = std::make_unique<ThreadState>(asyncSession_);
+        if (hasThreadQueues_) {
+            const size_t shard = tl::detail::currentNumaNode() % shardQueues_.size();
+            state->queue       = std::make_shared<ThreadQueue>(asyncOptions_.threadQueueCapacity, shard);
+
+            std::lock_guard<std::mutex> guard(threadQueuesMutex_);
+            shardQueues_[shard].push_back(state->queue);
+            threadQueuesVersion_.fetch_add(1, std::memory_order_release);
+            for (std::atomic<ThreadQueue*>& slot : asyncSession_->crashQueues)
+                if (!slot.load(std::memory_order_relaxed)) {
+                    slot.store(state->queue.get(), std::memory_order_release);
+                    break;
+                }
+        }
+
+        states.push_back(std::move(state));
+        return *states.back();
     }
 
-    void releaseFlag(const std::string& flagName) const {
-        // Locks mutex for thread-safety flag removal
-        std::lock_guard<std::mutex> guard(flagMutex_);
+    // Pops the oldest of the first records of the queues, to merge them by timestamp
+    static bool popOldest(const std::vector<std::shared_ptr<ThreadQueue>>& queues, AsyncRecord& record) {
+        ThreadQueue* oldestQueue  = nullptr;
+        AsyncRecord* oldestRecord = nullptr;
+        for (const std::shared_ptr<ThreadQueue>& queue : queues) {
+            AsyncRecord* front = queue->records.front();
+            if (front && (!oldestRecord || front->ticks < oldestRecord->ticks)) {
+                oldestQueue  = queue.get();
+                oldestRecord = front;
+            }
+        }
+        if (!oldestQueue)
+            return false;
 
-        auto iterator  = flagTimes_.find(flagName);
-        if  (iterator == flagTimes_.end())
-			logERROR("Flag '", flagName, "' could not be found in memory.");
-        else {
-            // Avoid using directly currentTime and elapsedTime for thread-safety
-            std::chrono::system_clock::time_point currentTimeFlag;
-            std::chrono::milliseconds             elapsedTimeFlag;
+        record = std::move(*oldestRecord);
+        oldestQueue->records.pop();
+        return true;
+    }
 
-            currentTimeFlag = std::chrono::system_clock::now();
-            elapsedTimeFlag = std::chrono::duration_cast<std::chrono::milliseconds>(currentTimeFlag - iterator->second);
+    // Copies the queues of a shard when a thread registered or released one
+    void refreshThreadQueues(size_t shard, std::vector<std::shared_ptr<ThreadQueue>>& queues, uint64_t& version) const {
+        if (threadQueuesVersion_.load(std::memory_order_acquire) == version)
+            return;
 
-            std::string elapsedTimeFlagString = std::to_string(elapsedTimeFlag.count() / 1000.0) + "\b\b\b seconds."; // \b for 3 digits
+        std::lock_guard<std::mutex> guard(threadQueuesMutex_);
+        version = threadQueuesVersion_.load(std::memory_order_relaxed);
+        queues  = shardQueues_[shard];
+    }
 
-			logINFO("Flag '", flagName, "' released after ", elapsedTimeFlagString);
-        }
+    // Forgets the queues of the threads that exited, once they are drained
+    void releaseThreadQueues(size_t shard, const std::vector<std::shared_ptr<ThreadQueue>>& queues) const {
+        // The thread no longer pushes once released, so an empty queue stays empty
+        const auto isDrained = [](const std::shared_ptr<ThreadQueue>& queue) {
+            return queue->isReleased.load(std::memory_order_acquire) && !queue->records.front();
+        };
+        if (std::none_of(queues.begin(), queues.end(), isDrained))
+            return;
+
+        std::lock_guard<std::mutex> guard(threadQueuesMutex_);
+        std::vector<std::shared_ptr<ThreadQueue>>& registered = shardQueues_[shard];
+
+        // Unlike remove_if, leaves the released queues at the end, so that their crash slots are cleared
+        const auto released = std::stable_partition(registered.begin(), registered.end(), [&isDrained](const std::shared_ptr<ThreadQueue>& queue) {
+            return !isDrained(queue);
+        });
+        for (auto queue = released; queue != registered.end(); ++queue)
+            for (std::atomic<ThreadQueue*>& slot : asyncSession_->crashQueues)
+                if (slot.load(std::memory_order_relaxed) == queue->get())
+                    slot.store(nullptr, std::memory_order_relaxed);
+        registered.erase(released, registered.end());
+        threadQueuesVersion_.fetch_add(1, std::memory_order_release);
     }
 
-private:
-    template <typename... Args>
-    INLINING_TINYLOGGER std::string formatMessage(Args&&... args) const {
+    /*
+     * Pops a batch of records, renders it without lock, then only takes
+     * logMutex_ to write it, so that the backends of the shards format their
+     * records in parallel. Their writes to the sinks are still serialized.
+     */
+    void backendLoop(size_t shard) const {
+        // Records are written in batches, and sinks notified once per batch
+        static const size_t maxBatchSize = 256;
+
+        // Queues of the threads of the shard, with AsyncOptions::threadQueues
+        std::vector<std::shared_ptr<ThreadQueue>> queues;
+        uint64_t                                  queuesVersion = 0;
 
-        // Computing and preparing the time string
-        currentTime_ = std::chrono::system_clock::now(); // Used to compute elapsed time since last log
-        elapsedTime_ = std::chrono::duration_cast<std::chrono::milliseconds>(currentTime_ - lastLogTime_);
+        // Held while popping, since the crash handler reads the thread queues too
+        std::atomic<ShardReader>* const reader = hasThreadQueues_ ? &asyncSession_->shardReaders[shard] : nullptr;
 
-        currentTimeInstanced_ = std::chrono::system_clock::to_time_t(currentTime_); // Printing current time
-        #ifdef _WIN32 // ctime_s is used for Windows compatibility
-            ctime_s(currentTimeChar_, sizeof(currentTimeChar_), &currentTimeInstanced_); currentTimeChar_[24] = '\0';
-        #else         // ctime_r is used for Linux compatibility
-            ctime_r(&currentTimeInstanced_, currentTimeChar_); currentTimeChar_[24] = '\0';
-        #endif        // Both are thread-safe while using ctime only is not
+        // Lines of the batch one after the other, a record not rendered ending where the previous one does
+        std::vector<AsyncRecord>                           batch(maxBatchSize);
+        std::vector<std::chrono::system_clock::time_point> times(maxBatchSize);
+        std::vector<size_t>                                lineEnds(maxBatchSize);
+        std::vector<uint64_t>                              formatNanoseconds(maxBatchSize);
+        std::string                                        lines;
 
-        elapsedTimeString_ = " +" + std::to_string(elapsedTime_.count() / 1000.0) + "\b\b\b s "; // \b for 3 digits
+        tl::detail::FormatBuffer&     buffer           = tl::detail::threadFormatBuffer();
+        tl::detail::ClockCalibration& clockCalibration = tl::detail::threadClockCalibration();
 
-		// Log arguments are concatenated into a single string
-        std::ostringstream streamMessage;
-        (streamMessage << ... << std::forward<Args>(args));
+        for (;;) {
+            // Reading the flag before draining ensures nothing is left behind
+            const bool isRunning = asyncRunning_.load(std::memory_order_acquire);
+            if (hasThreadQueues_)
+                refreshThreadQueues(shard, queues, queuesVersion);
 
-        std::string stringMessage = streamMessage.str();
+            ShardReader idle = ShardReader::NONE;
+            if (reader && !reader->compare_exchange_strong(idle, ShardReader::BACKEND, std::memory_order_acquire)) {
+                std::this_thread::sleep_for(asyncOptions_.backendSleep);
+                continue;
+            }
+
+            // Records waiting before the batch
+            size_t depth = enqueuedRecords_.load(std::memory_order_relaxed) - processedRecords_.load(std::memory_order_relaxed);
+            for (const std::shared_ptr<ThreadQueue>& queue : queues)
+                depth = std::max(depth, queue->records.pushed() - queue->records.popped());
+
+            const auto popRecord = [this, &queues](AsyncRecord& record) {
+                return hasThreadQueues_ ? popOldest(queues, record) : asyncQueue_->tryPop(record);
+            };
+            size_t batchSize = 0;
+            while (batchSize < maxBatchSize && popRecord(batch[batchSize]))
+                ++batchSize;
+
+            if (!batchSize && hasThreadQueues_)
+                releaseThreadQueues(shard, queues);
+            if (reader)
+                reader->store(ShardReader::NONE, std::memory_order_release);
+
+            // Rendered for the text sinks the call site has now, which may not accept the level
+            lines.clear();
+            for (size_t i = 0; i < batchSize; ++i) {
+                const AsyncRecord& record = batch[i];
+                times[i]             = clockCalibration.toSystemTime(record.ticks);
+                formatNanoseconds[i] = 0;
+                if (sinkKindsOf(*record.callSite) & textSinks) {
+                    const uint64_t start = tl::detail::TickClock::now();
+                    renderRecord(buffer, record, times[i]);
+                    lines.append(buffer.view());
+                    formatNanoseconds[i] = static_cast<uint64_t>(tl::detail::TickClock::toNanoseconds(static_cast<int64_t>(tl::detail::TickClock::now() - start)));
+                }
+                lineEnds[i] = lines.size();
+            }
+
+            {
+                // Producers never take this lock, it only protects sinks_
+                std::lock_guard<std::mutex> guard(logMutex_);
+
+                // The mark and the histograms are only updated here
+                if (depth > queueHighWaterMark_.load(std::memory_order_relaxed))
+                    queueHighWaterMark_.store(depth, std::memory_order_relaxed);
+
+                size_t lineStart = 0;
+                for (size_t i = 0; i < batchSize; ++i) {
+                    const AsyncRecord&                            record   = batch[i];
+                    const LogLevel                                logLevel = record.callSite->logLevel;
+                    const std::vector<std::shared_ptr<tl::Sink>>& sinks    = sinksOf(*record.callSite);
+                    const unsigned                                accepted = acceptingSinks(sinks, logLevel);
+                    const uint64_t                                start    = tl::detail::TickClock::now();
+
+                    if (accepted & binarySinks)
+                        dispatchBinary(sinks, tl::RecordView{ record.callSite, times[i], record.format, record.payloadData(), record.text() });
+
+                    if (accepted & textSinks) {
+                        std::string_view line(lines.data() + lineStart, lineEnds[i] - lineStart);
+                        if (line.empty()) {
+                            // A text sink was added since the batch was rendered
+                            renderRecord(buffer, record, times[i]);
+                            line = buffer.view();
+                        }
+                        dispatch(sinks, logLevel, line);
+                        formatLatency_.record(formatNanoseconds[i]);
+                    }
+                    const uint64_t writeTicks = tl::detail::TickClock::now() - start;
+                    writeLatency_.record(static_cast<uint64_t>(tl::detail::TickClock::toNanoseconds(static_cast<int64_t>(writeTicks))));
+                    lineStart = lineEnds[i];
+                }
+
+                // Idle time is used by sinks for periodic work, as flushing
+                forEachSink([batchSize](tl::Sink& sink) {
+                    if (batchSize > 0)
+                        sink.endBatch();
+                    else
+                        sink.poll();
+                });
+            }
+
+            for (size_t i = 0; i < batchSize; ++i)
+                if (batch[i].slab)
+                    arena_->release(batch[i].slab);
+
+            if (batchSize > 0) {
+                if (asyncQueue_)
+                    processedRecords_.fetch_add(batchSize, std::memory_order_release);
+                continue;
+            }
 
-		// Saving the current time for the next log
-        lastLogTime_ = currentTime_;
+            if (!isRunning)
+                return;
 
-		return std::string(currentTimeChar_) + elapsedTimeString_ + stringMessage;
+            std::this_thread::sleep_for(asyncOptions_.backendSleep);
+        }
+    }
+
+    // Log arguments are concatenated in the buffer of the thread, until its next use
+    static std::string_view formatArguments(const tl::detail::ArgumentPack& pack) {
+        tl::detail::FormatBuffer& buffer = tl::detail::threadFormatBuffer();
+        buffer.clear();
+        pack.format->append(pack.arguments, buffer);
+
+        return buffer.view();
+    }
+
+    void appendCrashHeader(tl::detail::FormatBuffer& buffer, StructuredFormat layout, LogLevel logLevel,
+                           std::chrono::system_clock::time_point time, int64_t elapsed) const {
+        const TimestampPrecision precision = timestampPrecision_.load(std::memory_order_relaxed);
+        if (layout != StructuredFormat::TEXT) {
+            tl::detail::appendStructuredHeader(buffer, layout, logLevel, time, elapsed, precision);
+            return;
+        }
+
+        char  header[64];
+        char* cursor = tl::detail::writeUtcTimestamp(header, time, precision);
+        cursor       = tl::detail::writeElapsed(cursor, elapsed, precision);
+
+        buffer.append(tl::detail::levelLabel(logLevel));
+        buffer.append(std::string_view(header, static_cast<size_t>(cursor - header)));
+    }
+
+    // Formats the line of a queued or recorded record
+    void renderRecord(tl::detail::FormatBuffer& buffer, const AsyncRecord& record, std::chrono::system_clock::time_point time) const {
+        buffer.clear();
+        appendHeader(buffer, record.layout, record.callSite->logLevel, time, record.elapsed);
+        if (record.format)
+            record.format->decode(record.payloadData(), buffer);
+        else
+            buffer.append(record.text());
+        buffer.append('\n');
     }
 
-    LogLevel logLevel_;
+    /*
+     * @brief Appends the level, the current time and the time elapsed since
+     *        the previous record, as computed by elapsedOf, as fields if the
+     *        record is structured. The timestamp cache is the one of the
+     *        calling thread, so formatting does not need any lock.
+     */
+    void appendHeader(tl::detail::FormatBuffer& buffer, StructuredFormat layout, LogLevel logLevel,
+                      std::chrono::system_clock::time_point time, int64_t elapsed) const {
+        const TimestampPrecision precision = timestampPrecision_.load(std::memory_order_relaxed);
+        if (layout != StructuredFormat::TEXT) {
+            tl::detail::appendStructuredHeader(buffer, layout, logLevel, time, elapsed, precision);
+            return;
+        }
+
+        buffer.append(tl::detail::levelLabel(logLevel));
+        buffer.append(tl::detail::threadTimestampCache().render(time, timestampFormat_.load(std::memory_order_relaxed), precision));
+
+        char        elapsedText[32];
+        const char* end = tl::detail::writeElapsed(elapsedText, elapsed, precision);
+        buffer.append(std::string_view(elapsedText, static_cast<size_t>(end - elapsedText)));
+    }
 
-    // Used to compute time between every logging event
-    mutable std::chrono::system_clock::time_point currentTime_;
-    mutable std::chrono::system_clock::time_point lastLogTime_;
-	mutable std::chrono::milliseconds elapsedTime_ = std::chrono::milliseconds(0);
+    // Read without lock on every call, and changed by setLogLevel
+    std::atomic<LogLevel> logLevel_;
 
     // Used in order to print current and elapsed time
-    mutable time_t currentTimeInstanced_; 
-    mutable char   currentTimeChar_[26];
-    mutable std::string elapsedTimeString_;
+    std::atomic<TimestampFormat>        timestampFormat_{ TimestampFormat::CTIME };
+    std::atomic<TimestampPrecision>     timestampPrecision_{ TimestampPrecision::SECONDS };
+    std::atomic<ElapsedScope>           elapsedScope_{ ElapsedScope::THREAD };
+    std::atomic<StructuredFormat>       structuredFormat_{ StructuredFormat::TEXT };
+
+    // Tick of the previous record without category, with ElapsedScope::CATEGORY
+    alignas(tl::detail::cacheLineSize) mutable std::atomic<uint64_t> lastLogTime_{ 0 };
 
-    // Used to update a progress bar for current status
-    mutable std::atomic<size_t> currentIteration_{ 0 };
-    mutable std::atomic<size_t> numberIterations_{ 1 };
+    // Preallocated by prepareCrashFlush for the lines of crashFlush, see FormatBuffer::bound
+    struct CrashState {
+        tl::detail::FormatBuffer     buffer;
+        tl::detail::ClockCalibration clockCalibration;
+        char                         spill[1 << 16];
+    };
+    std::unique_ptr<CrashState> crashState_;
+
+    // Sinks published for crashFlush, which can't take logMutex_, see publishCrashSinks
+    struct CrashSink {
+        std::atomic<tl::Sink*>           sink{ nullptr };
+        std::atomic<const tl::Category*> category{ nullptr }; // Null for a sink of the logger
+    };
+    static constexpr size_t              maxCrashSinks = 32;
+    std::array<CrashSink, maxCrashSinks> crashSinks_;
+    std::atomic<size_t>                  crashSinkCount_{ 0 };
+
+    // Used to update a progress bar for current status, see displayProgressBar
+    mutable tl::ProgressBar progressBar_{ "", 1 };
+
+    // Number of iterations of the loop of the bar, shifted by one, the low bit set while it is reset
+    mutable std::atomic<uint64_t> progressLoop_{ 1 << 1 };
 
     // Flags can be added to memory to track specific time events
-    mutable std::unordered_map<std::string, std::chrono::system_clock::time_point> flagTimes_;
+    mutable std::unordered_map<std::string, std::chrono::steady_clock::time_point> flagTimes_;
+
+    // Ticks between two reports of the scoped timers, and tick of the next one
+    std::atomic<int64_t>          timerReportInterval_{ 0 };
+    mutable std::atomic<uint64_t> nextTimerReport_{ 0 };
 
     // Mutex added for thread-safety
 	mutable std::mutex flagMutex_; // Mutex to synchronize flags access
 	mutable std::mutex logMutex_;  // Mutex to synchronize logger access
+
+    // Asynchronous mode: queue is only allocated once startAsync is called
+    AsyncOptions                                          asyncOptions_;
+    std::unique_ptr<tl::detail::BoundedQueue<AsyncRecord>> asyncQueue_;
+    std::vector<std::thread>                              asyncThreads_;
+    std::atomic<bool>                                     asyncRunning_{ false };
+
+    // Queues of the producer threads by shard instead, with AsyncOptions::threadQueues
+    bool                                                           hasThreadQueues_ = false;
+    std::shared_ptr<AsyncSession>                                  asyncSession_;
+    tl::detail::RecordArena*                                       arena_ = nullptr;
+    mutable std::vector<std::vector<std::shared_ptr<ThreadQueue>>> shardQueues_;
+    mutable std::mutex                                             threadQueuesMutex_;
+    mutable std::atomic<uint64_t>                                  threadQueuesVersion_{ 0 };
+
+    // Counters used by flush to know when every queued record was written
+    alignas(tl::detail::cacheLineSize) mutable std::atomic<size_t> enqueuedRecords_{ 0 };
+    alignas(tl::detail::cacheLineSize) mutable std::atomic<size_t> processedRecords_{ 0 };
+    mutable std::atomic<size_t> droppedRecords_{ 0 };
+
+    // Statistics, see stats: counters of the producers, and the ones of the backend
+    mutable std::array<tl::detail::StatsStripe, 16> statsStripes_;
+    mutable std::atomic<size_t>                     queueHighWaterMark_{ 0 };
+    mutable tl::detail::TimerHistogram              formatLatency_;
+    mutable tl::detail::TimerHistogram              writeLatency_;
+
+    // Destinations of the lines, protected by logMutex_
+    std::vector<std::shared_ptr<tl::Sink>> sinks_{ std::make_shared<tl::ConsoleSink>() };
+    std::atomic<unsigned>                  sinkKinds_{ textSinks };
+
+    // Thread applying the levels of a file, see watchConfig
+    std::unique_ptr<tl::detail::DirectoryWatcher> configWatcher_;
+    std::thread                                   configThread_;
+
+    // Rings of the records disabled by the log level, see enableBacktrace
+    std::atomic<LogLevel>             backtraceLevel_{ LogLevel::OFF };
+    std::shared_ptr<BacktraceSession> backtrace_;
+
+    // Categories by name, and the ones writing to their own sinks, see category
+    std::unordered_map<std::string, std::unique_ptr<tl::Category>> categories_;
+    std::vector<tl::Category*>                                     categoriesWithSinks_;
 };
 
 
+/*
+ * Backend of the logger, compiled in every translation unit with the header,
+ * or once by the tinylogger library, see TINYLOGGER_COMPILED.
+ */
+#if (!TINYLOGGER_COMPILED) || defined(TINYLOGGER_IMPLEMENTATION)
+
+TINYLOGGER_BACKEND void Logger::logPacked(const tl::CallSite& callSite, const tl::detail::ArgumentPack& pack) const {
+    if (isBacktraced(callSite)) {
+        recordBacktrace(callSite, pack);
+        return;
+    }
+    emit(callSite, pack);
+    if (callSite.logLevel == LogLevel::CRITICAL)
+        terminate();
+}
+
+TINYLOGGER_BACKEND void Logger::emit(const tl::CallSite& callSite, const tl::detail::ArgumentPack& pack) const {
+    // The records that led to an error are written before it
+    if (callSite.logLevel <= LogLevel::LERROR && backtraceLevel_.load(std::memory_order_relaxed) != LogLevel::OFF)
+        dumpThreadBacktrace();
+
+    tl::detail::StatsStripe& stripe = statsStripe();
+    stripe.emitted[static_cast<size_t>(callSite.logLevel)].fetch_add(1, std::memory_order_relaxed);
+
+    if (isAsync()) {
+        AsyncRecord record;
+        record.callSite = &callSite;
+        record.ticks    = tl::detail::TickClock::now();
+        record.elapsed  = elapsedOf(callSite, record.ticks);
+        record.layout   = pack.format->layout(pack.arguments);
+
+        // Arguments too large for the payload go to the arena, or are formatted right away
+        bool canUseArena = arena_ != nullptr;
+        if (pack.format->payloadFormat) {
+            char* cursor = record.payload;
+            if (pack.format->encode(pack.arguments, cursor, record.payload + sizeof(record.payload)))
+                record.format = pack.format->payloadFormat;
+            else if (canUseArena) {
+                const ArenaOutcome outcome = storeInArena(record, [&pack](char*& cursor, const char* end) {
+                    return pack.format->encode(pack.arguments, cursor, end);
+                });
+                if (outcome == ArenaOutcome::DROPPED)
+                    return;
+                if (outcome == ArenaOutcome::STORED)
+                    record.format = pack.format->payloadFormat;
+                canUseArena = false;
+            }
+        }
+
+        if (!record.format) {
+            const std::string_view message = formatArguments(pack);
+            const ArenaOutcome     outcome = canUseArena ? storeInArena(record, [message](char*& cursor, const char* end) {
+                if (static_cast<size_t>(end - cursor) < message.size())
+                    return false;
+                cursor = std::copy(message.begin(), message.end(), cursor);
+                return true;
+            }) : ArenaOutcome::HEAP;
+            if (outcome == ArenaOutcome::DROPPED)
+                return;
+            if (outcome == ArenaOutcome::HEAP)
+                record.message = message;
+        }
+
+        enqueue(std::move(record));
+        return;
+    }
+
+    const LogLevel                              logLevel = callSite.logLevel;
+    const uint64_t                              ticks    = tl::detail::TickClock::now();
+    const int64_t                               elapsed  = elapsedOf(callSite, ticks);
+    const std::chrono::system_clock::time_point time     = tl::detail::threadClockCalibration().toSystemTime(ticks);
+
+    // The line is formatted before locking, when a text sink may take it
+    tl::detail::FormatBuffer& buffer      = tl::detail::threadFormatBuffer();
+    const bool                isFormatted = sinkKindsOf(callSite) & textSinks;
+    if (isFormatted)
+        formatLine(buffer, logLevel, time, elapsed, pack);
+
+    // Locks mutex during dispatch for thread-safety of the sinks, timing the wait if any
+    std::unique_lock<std::mutex> guard(logMutex_, std::try_to_lock);
+    if (!guard.owns_lock()) {
+        const uint64_t waitStart = tl::detail::TickClock::now();
+        guard.lock();
+        stripe.blockedTicks.fetch_add(tl::detail::TickClock::now() - waitStart, std::memory_order_relaxed);
+    }
+
+    const std::vector<std::shared_ptr<tl::Sink>>& sinks    = sinksOf(callSite);
+    const unsigned                                accepted = acceptingSinks(sinks, logLevel);
+    if (!accepted)
+        return;
+
+    if (accepted & textSinks) {
+        // Unless a text sink was added since sinkKindsOf was read
+        if (!isFormatted)
+            formatLine(buffer, logLevel, time, elapsed, pack);
+        dispatch(sinks, logLevel, buffer.view());
+    }
+
+    // After the text sinks, since it reuses the buffer of the thread
+    if (accepted & binarySinks)
+        emitBinary(sinks, callSite, time, pack);
+
+    for (const std::shared_ptr<tl::Sink>& sink : sinks)
+        sink->endBatch();
+}
+
+#endif
+
+
 /*
  * Inline logger instance that can be used in the code, originally defined with
  * a LogLevel::TRACE log level. This logger instance is used by the macros, and
@@ -353,37 +6704,189 @@ private:
 inline Logger logger(LogLevel::TRACE);
 
 
+namespace tl {
+namespace detail {
+
+    // Levels of the default logger, set by the environment, see Runtime Configuration
+    inline const bool isLoggerConfigured = []() {
+        logger.configureFromEnvironment("TINYLOGGER_LEVEL");
+        if (const char* path = std::getenv("TINYLOGGER_CONFIG"))
+            logger.watchConfig(path);
+        return true;
+    }();
+
+} // namespace detail
+
+} // namespace tl
+
+
+namespace tl {
+
+    /*
+     * @brief Records the lifetime of its scope, in nanoseconds, into the
+     *        histogram of the calling thread for its site. See TL_SCOPED_TIMER.
+     */
+    class ScopedTimer {
+    public:
+        explicit ScopedTimer(const TimerSite& site)
+            : histogram_(site.threadHistogram()), start_(detail::TickClock::now()) {}
+
+        ScopedTimer(const ScopedTimer&)            = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+        ~ScopedTimer() {
+            const uint64_t end         = detail::TickClock::now();
+            const int64_t  nanoseconds = detail::TickClock::toNanoseconds(static_cast<int64_t>(end - start_));
+            histogram_.record(static_cast<uint64_t>(std::max<int64_t>(nanoseconds, 0)));
+            logger.reportTimersIfDue(end);
+        }
+
+    private:
+        detail::TimerHistogram& histogram_;
+        const uint64_t          start_;
+    };
+
+namespace detail {
+
+    inline std::atomic<bool> isCrashing{ false };
+    inline std::terminate_handler previousTerminateHandler = nullptr;
+
+    inline const char* signalName(int signal) {
+        switch (signal) {
+            case SIGSEGV: return "Received signal SIGSEGV";
+            case SIGABRT: return "Received signal SIGABRT";
+            case SIGFPE:  return "Received signal SIGFPE";
+            case SIGILL:  return "Received signal SIGILL";
+            #ifdef SIGBUS
+            case SIGBUS:  return "Received signal SIGBUS";
+            #endif
+            default:      return "Received a fatal signal";
+        }
+    }
+
+    // Flushes once, then lets the signal terminate the process as it would have
+    inline void crashSignalHandler(int signal) {
+        if (!isCrashing.exchange(true))
+            logger.crashFlush(signalName(signal));
+
+        std::signal(signal, SIG_DFL);
+        std::raise(signal);
+    }
+
+    inline void crashTerminateHandler() {
+        if (!isCrashing.exchange(true))
+            logger.crashFlush("Called std::terminate");
+
+        if (previousTerminateHandler)
+            previousTerminateHandler();
+        std::abort();
+    }
+
+} // namespace detail
+
+    /*
+     * @brief Makes the global logger write its pending lines on a crash, so
+     *        that large buffers and the asynchronous mode can be used without
+     *        losing the last lines before it. Handles SIGSEGV, SIGBUS, SIGFPE,
+     *        SIGILL, SIGABRT and std::terminate, see Logger::crashFlush, then
+     *        lets the process terminate as it would have without the handler.
+     *
+     * @note Opt-in, since it replaces the handlers of these signals. With
+     *       sigaction, handlers run on an alternate stack, so that a stack
+     *       overflow is handled, but only for the thread calling this function.
+     */
+    inline void installCrashHandler() {
+        static const int signals[] = {
+            SIGSEGV, SIGABRT, SIGFPE, SIGILL,
+            #ifdef SIGBUS
+            SIGBUS,
+            #endif
+        };
+
+        logger.prepareCrashFlush();
+        #if defined(__unix__) || defined(__APPLE__)
+            static char alternateStack[1 << 16];
+            stack_t stack{};
+            stack.ss_sp    = alternateStack;
+            stack.ss_size  = sizeof(alternateStack);
+            sigaltstack(&stack, nullptr);
+
+            struct sigaction action{};
+            action.sa_handler = &detail::crashSignalHandler;
+            action.sa_flags   = SA_ONSTACK;
+            sigemptyset(&action.sa_mask);
+            for (int signal : signals)
+                sigaction(signal, &action, nullptr);
+        #else
+            for (int signal : signals)
+                std::signal(signal, &detail::crashSignalHandler);
+        #endif
+
+        detail::previousTerminateHandler = std::set_terminate(&detail::crashTerminateHandler);
+    }
+
+} // namespace tl
+
+
 /*
- * Generates a sequence of context information arguments to be prepended to the
- * log messages, depending on compile-time flags. In order, this macro includes
- * the following, in order:
+ * Generates the context information prepended to the log messages, depending
+ * on compile-time flags. In order, this macro includes the following:
  *  - Function name: in which the log message is generated if LOG_FUNCTION_NAME
  *  - File name    : in which the log message is generated if LOG_FILE_NAME
  *  - Line number  : in which the log message is generated if LOG_LINE_NUMBER
  * 
- * These components are passed as separate arguments to the macro associated to
- * the variadic logger function, which is responsible for concatenating them.
+ * These components are joined into a single static string per macro expansion,
+ * the file being reduced to its base name. Without the function name, this is
+ * done during the compilation, otherwise on the first execution of the macro.
+ * The binary sinks intern the string, and then only write its id.
  */
 
 #define   STR(x)    #x
 #define TOSTR(x) STR(x)
 
+// Marks a context piece as static, so that it is not copied by async records
+#define  SSTR(x) tl::StaticString(x)
+
+// Call site owned by the macro expansion, created on its first execution
+#define TL_CALL_SITE(logLevel) \
+    ([]() -> const tl::CallSite& { static const tl::CallSite callSite(logLevel); return callSite; }())
+
+// Category of the global logger, looked up once per macro expansion
+#define TL_CATEGORY(name) \
+    ([]() -> tl::Category& { static tl::Category& category = logger.category(#name); return category; }())
+
+// Logs only if the call site is enabled, so that disabled arguments are never evaluated
+#define TL_LOG_IF_ENABLED(callSiteArguments, ...)                          \
+    do {                                                                   \
+        static const tl::CallSite tlCallSite callSiteArguments;            \
+        if (logger.isEnabled(tlCallSite))                                  \
+            logger.logDirect(tlCallSite, __VA_ARGS__);                     \
+    } while (0)
+
+// Context known at compile time, with the directories of the file removed
+#define TL_STATIC_CONTEXT(head, file, tail) \
+    ([]() { static constexpr auto context = tl::detail::joinContext(head, file, tail); return tl::StaticString(context.data, context.size); }())
+
+// Context starting with the function name, joined once per macro expansion
+#define TL_FUNCTION_CONTEXT(head, file, tail) \
+    tl::detail::functionContext([] {}, __FUNCTION__, TL_STATIC_CONTEXT(head, file, tail))
+
 #if    LOG_FUNCTION_NAME &&  LOG_FILE_NAME &&  LOG_LINE_NUMBER
-#   define LOG_CONTEXT() __FUNCTION__, ": in [", __FILE__, "] (l. ", TOSTR(__LINE__), ") "
+#   define LOG_CONTEXT() TL_FUNCTION_CONTEXT(": in [", __FILE__, "] (l. " TOSTR(__LINE__) ") ")
 #elif  LOG_FUNCTION_NAME &&  LOG_FILE_NAME && !LOG_LINE_NUMBER
-#   define LOG_CONTEXT() __FUNCTION__, ": in [", __FILE__, "] "
+#   define LOG_CONTEXT() TL_FUNCTION_CONTEXT(": in [", __FILE__, "] ")
 #elif  LOG_FUNCTION_NAME && !LOG_FILE_NAME &&  LOG_LINE_NUMBER
-#   define LOG_CONTEXT() __FUNCTION__, ": "
+#   define LOG_CONTEXT() TL_FUNCTION_CONTEXT(": (l. " TOSTR(__LINE__) ") ", "", "")
 #elif  LOG_FUNCTION_NAME && !LOG_FILE_NAME && !LOG_LINE_NUMBER
-#   define LOG_CONTEXT() __FUNCTION__, ": (l. ", TOSTR(__LINE__), ") "
+#   define LOG_CONTEXT() TL_FUNCTION_CONTEXT(": ", "", "")
 #elif !LOG_FUNCTION_NAME &&  LOG_FILE_NAME &&  LOG_LINE_NUMBER
-#   define LOG_CONTEXT() " in [", __FILE__, "] (l. ", TOSTR(__LINE__), ") "
+#   define LOG_CONTEXT() TL_STATIC_CONTEXT(" in [", __FILE__, "] (l. " TOSTR(__LINE__) ") ")
 #elif !LOG_FUNCTION_NAME &&  LOG_FILE_NAME && !LOG_LINE_NUMBER
-#   define LOG_CONTEXT() " in [", __FILE__, "] "
+#   define LOG_CONTEXT() TL_STATIC_CONTEXT(" in [", __FILE__, "] ")
 #elif !LOG_FUNCTION_NAME && !LOG_FILE_NAME &&  LOG_LINE_NUMBER
-#   define LOG_CONTEXT() " (l. ", TOSTR(__LINE__), ") "
+#   define LOG_CONTEXT() TL_STATIC_CONTEXT(" (l. " TOSTR(__LINE__) ") ", "", "")
 #else
-#   define LOG_CONTEXT() ""
+#   define LOG_CONTEXT() SSTR("")
 #endif
 
 
@@ -406,7 +6909,7 @@ inline Logger logger(LogLevel::TRACE);
     * @param ... (variadic): Any arguments of any streamable type, concatenated
     *                        into the log message.
     */
-#   define LOG_TRACE(...)    logger.log(LogLevel::TRACE   , LOG_CONTEXT(), __VA_ARGS__)
+#   define LOG_TRACE(...)    TL_LOG_IF_ENABLED((LogLevel::TRACE),    LOG_CONTEXT(), __VA_ARGS__)
    /*
     * @brief Logs a message at the DEBUG severity level.
     *
@@ -416,7 +6919,7 @@ inline Logger logger(LogLevel::TRACE);
     * @param ... (variadic): Any arguments of any streamable type, concatenated
     *                        into the log message.
     */
-#   define LOG_DEBUG(...)    logger.log(LogLevel::DEBUG   , LOG_CONTEXT(), __VA_ARGS__)
+#   define LOG_DEBUG(...)    TL_LOG_IF_ENABLED((LogLevel::DEBUG),    LOG_CONTEXT(), __VA_ARGS__)
    /*
     * @brief Logs a message at the VERBOSE severity level.
     *
@@ -426,7 +6929,7 @@ inline Logger logger(LogLevel::TRACE);
     * @param ... (variadic): Any arguments of any streamable type, concatenated
     *                        into the log message.
 	*/
-#   define LOG_VERBOSE(...)  logger.log(LogLevel::VERBOSE , LOG_CONTEXT(), __VA_ARGS__)
+#   define LOG_VERBOSE(...)  TL_LOG_IF_ENABLED((LogLevel::VERBOSE),  LOG_CONTEXT(), __VA_ARGS__)
    /*
     * @brief Logs a message at the INFO severity level.
     *
@@ -436,7 +6939,7 @@ inline Logger logger(LogLevel::TRACE);
     * @param ... (variadic): Any arguments of any streamable type, concatenated
     *                        into the log message.
 	*/
-#   define LOG_INFO(...)     logger.log(LogLevel::INFO    , LOG_CONTEXT(), __VA_ARGS__)
+#   define LOG_INFO(...)     TL_LOG_IF_ENABLED((LogLevel::INFO),     LOG_CONTEXT(), __VA_ARGS__)
    /*
     * @brief Logs a message at the WARNING severity level.
     *
@@ -446,7 +6949,7 @@ inline Logger logger(LogLevel::TRACE);
     * @param ... (variadic): Any arguments of any streamable type, concatenated
     *                        into the log message.
 	*/
-#   define LOG_WARNING(...)  logger.log(LogLevel::WARNING , LOG_CONTEXT(), __VA_ARGS__)
+#   define LOG_WARNING(...)  TL_LOG_IF_ENABLED((LogLevel::WARNING),  LOG_CONTEXT(), __VA_ARGS__)
    /*
     * @brief Logs a message at the LERROR severity level.
     *
@@ -456,7 +6959,7 @@ inline Logger logger(LogLevel::TRACE);
     * @param ... (variadic): Any arguments of any streamable type, concatenated
     *                        into the log message.
 	*/
-#   define LOG_ERROR(...)    logger.log(LogLevel::LERROR  , LOG_CONTEXT(), __VA_ARGS__)
+#   define LOG_ERROR(...)    TL_LOG_IF_ENABLED((LogLevel::LERROR),   LOG_CONTEXT(), __VA_ARGS__)
    /*
     * @brief Logs a message at the CRITICAL severity level. This exits program.
     *
@@ -466,7 +6969,7 @@ inline Logger logger(LogLevel::TRACE);
     * @param ... (variadic): Any arguments of any streamable type, concatenated
     *                        into the log message.
 	*/
-#   define LOG_CRITICAL(...) logger.log(LogLevel::CRITICAL, LOG_CONTEXT(), __VA_ARGS__)
+#   define LOG_CRITICAL(...) TL_LOG_IF_ENABLED((LogLevel::CRITICAL), LOG_CONTEXT(), __VA_ARGS__)
 #else
    /*
     * @brief Logs a message at the TRACE severity level. Is optimised to bypass
@@ -478,7 +6981,7 @@ inline Logger logger(LogLevel::TRACE);
     * @param ... (variadic): Any arguments of any streamable type, concatenated
     *                        into the log message.
     */
-#   define LOG_TRACE(...)    logger.logTRACE(   LOG_CONTEXT(), __VA_ARGS__)
+#   define LOG_TRACE(...)    logger.logDirect(        TL_CALL_SITE(LogLevel::TRACE   ), LOG_CONTEXT(), __VA_ARGS__)
    /*
     * @brief Logs a message at the DEBUG severity level. Is optimised to bypass
     *        all the checks and directly call the log function.
@@ -489,7 +6992,7 @@ inline Logger logger(LogLevel::TRACE);
     * @param ... (variadic): Any arguments of any streamable type, concatenated
     *                        into the log message.
 	*/
-#   define LOG_DEBUG(...)    logger.logDEBUG(   LOG_CONTEXT(), __VA_ARGS__)
+#   define LOG_DEBUG(...)    logger.logDirect(        TL_CALL_SITE(LogLevel::DEBUG   ), LOG_CONTEXT(), __VA_ARGS__)
    /*
     * @brief Logs a message at the VERBOSE severity level. Is optimised to bypass
     *        all the checks and directly call the log function.
@@ -500,7 +7003,7 @@ inline Logger logger(LogLevel::TRACE);
     * @param ... (variadic): Any arguments of any streamable type, concatenated
     *                        into the log message.
 	*/
-#   define LOG_VERBOSE(...)  logger.logVERBOSE( LOG_CONTEXT(), __VA_ARGS__)
+#   define LOG_VERBOSE(...)  logger.logDirect(        TL_CALL_SITE(LogLevel::VERBOSE ), LOG_CONTEXT(), __VA_ARGS__)
    /*
     * @brief Logs a message at the INFO severity level. Is optimised to bypass
     *        all the checks and directly call the log function.
@@ -511,7 +7014,7 @@ inline Logger logger(LogLevel::TRACE);
     * @param ... (variadic): Any arguments of any streamable type, concatenated
     *                        into the log message.
 	*/
-#   define LOG_INFO(...)     logger.logINFO(    LOG_CONTEXT(), __VA_ARGS__)
+#   define LOG_INFO(...)     logger.logDirect(        TL_CALL_SITE(LogLevel::INFO    ), LOG_CONTEXT(), __VA_ARGS__)
    /*
     * @brief Logs a message at the WARNING severity level. Is optimised to bypass
     *        all the checks and directly call the log function.
@@ -522,7 +7025,7 @@ inline Logger logger(LogLevel::TRACE);
     * @param ... (variadic): Any arguments of any streamable type, concatenated
     *                        into the log message.
 	*/
-#   define LOG_WARNING(...)  logger.logWARNING( LOG_CONTEXT(), __VA_ARGS__)
+#   define LOG_WARNING(...)  logger.logDirect(        TL_CALL_SITE(LogLevel::WARNING ), LOG_CONTEXT(), __VA_ARGS__)
    /*
     * @brief Logs a message at the ERROR severity level. Is optimised to bypass
     *        all the checks and directly call the log function.
@@ -533,7 +7036,7 @@ inline Logger logger(LogLevel::TRACE);
     * @param ... (variadic): Any arguments of any streamable type, concatenated
     *                        into the log message.
 	*/
-#   define LOG_ERROR(...)    logger.logERROR(   LOG_CONTEXT(), __VA_ARGS__)
+#   define LOG_ERROR(...)    logger.logDirect(        TL_CALL_SITE(LogLevel::LERROR  ), LOG_CONTEXT(), __VA_ARGS__)
    /*
     * @brief Logs a message at the CRITICAL severity level. Is optimised to bypass
     *        all the checks and directly call the log function. This exits program.
@@ -544,10 +7047,180 @@ inline Logger logger(LogLevel::TRACE);
     * @param ... (variadic): Any arguments of any streamable type, concatenated
     *                        into the log message.
 	*/
-#   define LOG_CRITICAL(...) logger.logCRITICAL(LOG_CONTEXT(), __VA_ARGS__)
+#   define LOG_CRITICAL(...) logger.logDirectCritical(TL_CALL_SITE(LogLevel::CRITICAL), LOG_CONTEXT(), __VA_ARGS__)
 #endif
 
 
+/*
+ * =========================================================================
+ *                          Category Logger Macros
+ * =========================================================================
+ *
+ * The LOG_<LEVEL>_CAT macros log in the given category of the global logger,
+ * as TL_CATEGORY(net).setLogLevel(LogLevel::TRACE) only enables "net". The
+ * category is looked up once per expansion, its level checked at runtime.
+ * Lines start with the category name, after the time.
+ *
+ * @param category Identifier naming the category, as net for "net".
+ * @param ...      (variadic): Any arguments of any streamable type.
+ */
+#define TL_LOG_IN_CATEGORY(category, logLevel, ...) \
+    TL_LOG_IF_ENABLED((logLevel, &TL_CATEGORY(category)), SSTR("[" #category "] "), LOG_CONTEXT(), __VA_ARGS__)
+
+#define LOG_TRACE_CAT(category, ...)    TL_LOG_IN_CATEGORY(category, LogLevel::TRACE,    __VA_ARGS__)
+#define LOG_DEBUG_CAT(category, ...)    TL_LOG_IN_CATEGORY(category, LogLevel::DEBUG,    __VA_ARGS__)
+#define LOG_VERBOSE_CAT(category, ...)  TL_LOG_IN_CATEGORY(category, LogLevel::VERBOSE,  __VA_ARGS__)
+#define LOG_INFO_CAT(category, ...)     TL_LOG_IN_CATEGORY(category, LogLevel::INFO,     __VA_ARGS__)
+#define LOG_WARNING_CAT(category, ...)  TL_LOG_IN_CATEGORY(category, LogLevel::WARNING,  __VA_ARGS__)
+#define LOG_ERROR_CAT(category, ...)    TL_LOG_IN_CATEGORY(category, LogLevel::LERROR,   __VA_ARGS__)
+#define LOG_CRITICAL_CAT(category, ...) TL_LOG_IN_CATEGORY(category, LogLevel::CRITICAL, __VA_ARGS__)
+
+
+/*
+ * =========================================================================
+ *                        Rate-Limited Logger Macros
+ * =========================================================================
+ *
+ * These macros only log some of their calls, with a limiter owned by the
+ * expansion, see tl::EveryN, tl::EveryInterval and tl::TokenBucket:
+ *  - LOG_<LEVEL>_EVERY_N(n, ...)                : one call out of n
+ *  - LOG_<LEVEL>_EVERY_MS(interval, ...)        : one call per interval, in
+ *                                                 milliseconds
+ *  - LOG_<LEVEL>_RATE_LIMITED(rate, burst, ...) : rate calls per second, and
+ *                                                 burst of them at once
+ * The limits are evaluated once. A logged line following discarded calls
+ * ends with their number, as "(41 suppressed)". Calls at a disabled level
+ * are neither logged nor counted.
+ *
+ * @param ... (variadic): Any arguments of any streamable type.
+ */
+#define TL_LOG_LIMITED(logLevel, limiter, ...)                                                                     \
+    do {                                                                                                           \
+        static const tl::CallSite tlCallSite(logLevel);                                                            \
+        static limiter;                                                                                            \
+        uint64_t tlSuppressed = 0;                                                                                 \
+        if (!logger.isEnabled(tlCallSite))                                                                         \
+            break;                                                                                                 \
+        if (!tlLimiter.admit(tlSuppressed))                                                                        \
+            logger.countSuppressed(tlCallSite);                                                                    \
+        else if (tlSuppressed)                                                                                     \
+            logger.logDirect(tlCallSite, LOG_CONTEXT(), __VA_ARGS__, SSTR(" ("), tlSuppressed, SSTR(" suppressed)")); \
+        else                                                                                                       \
+            logger.logDirect(tlCallSite, LOG_CONTEXT(), __VA_ARGS__);                                              \
+    } while (0)
+
+#define TL_LOG_EVERY_N(logLevel, n, ...)                 TL_LOG_LIMITED(logLevel, tl::EveryN tlLimiter(n), __VA_ARGS__)
+#define TL_LOG_EVERY_MS(logLevel, interval, ...)         TL_LOG_LIMITED(logLevel, tl::EveryInterval tlLimiter(std::chrono::milliseconds(interval)), __VA_ARGS__)
+#define TL_LOG_RATE_LIMITED(logLevel, rate, burst, ...)  TL_LOG_LIMITED(logLevel, tl::TokenBucket tlLimiter(rate, burst), __VA_ARGS__)
+
+#define LOG_TRACE_EVERY_N(n, ...)    TL_LOG_EVERY_N(LogLevel::TRACE,    n, __VA_ARGS__)
+#define LOG_DEBUG_EVERY_N(n, ...)    TL_LOG_EVERY_N(LogLevel::DEBUG,    n, __VA_ARGS__)
+#define LOG_VERBOSE_EVERY_N(n, ...)  TL_LOG_EVERY_N(LogLevel::VERBOSE,  n, __VA_ARGS__)
+#define LOG_INFO_EVERY_N(n, ...)     TL_LOG_EVERY_N(LogLevel::INFO,     n, __VA_ARGS__)
+#define LOG_WARNING_EVERY_N(n, ...)  TL_LOG_EVERY_N(LogLevel::WARNING,  n, __VA_ARGS__)
+#define LOG_ERROR_EVERY_N(n, ...)    TL_LOG_EVERY_N(LogLevel::LERROR,   n, __VA_ARGS__)
+#define LOG_CRITICAL_EVERY_N(n, ...) TL_LOG_EVERY_N(LogLevel::CRITICAL, n, __VA_ARGS__)
+
+#define LOG_TRACE_EVERY_MS(interval, ...)    TL_LOG_EVERY_MS(LogLevel::TRACE,    interval, __VA_ARGS__)
+#define LOG_DEBUG_EVERY_MS(interval, ...)    TL_LOG_EVERY_MS(LogLevel::DEBUG,    interval, __VA_ARGS__)
+#define LOG_VERBOSE_EVERY_MS(interval, ...)  TL_LOG_EVERY_MS(LogLevel::VERBOSE,  interval, __VA_ARGS__)
+#define LOG_INFO_EVERY_MS(interval, ...)     TL_LOG_EVERY_MS(LogLevel::INFO,     interval, __VA_ARGS__)
+#define LOG_WARNING_EVERY_MS(interval, ...)  TL_LOG_EVERY_MS(LogLevel::WARNING,  interval, __VA_ARGS__)
+#define LOG_ERROR_EVERY_MS(interval, ...)    TL_LOG_EVERY_MS(LogLevel::LERROR,   interval, __VA_ARGS__)
+#define LOG_CRITICAL_EVERY_MS(interval, ...) TL_LOG_EVERY_MS(LogLevel::CRITICAL, interval, __VA_ARGS__)
+
+#define LOG_TRACE_RATE_LIMITED(rate, burst, ...)    TL_LOG_RATE_LIMITED(LogLevel::TRACE,    rate, burst, __VA_ARGS__)
+#define LOG_DEBUG_RATE_LIMITED(rate, burst, ...)    TL_LOG_RATE_LIMITED(LogLevel::DEBUG,    rate, burst, __VA_ARGS__)
+#define LOG_VERBOSE_RATE_LIMITED(rate, burst, ...)  TL_LOG_RATE_LIMITED(LogLevel::VERBOSE,  rate, burst, __VA_ARGS__)
+#define LOG_INFO_RATE_LIMITED(rate, burst, ...)     TL_LOG_RATE_LIMITED(LogLevel::INFO,     rate, burst, __VA_ARGS__)
+#define LOG_WARNING_RATE_LIMITED(rate, burst, ...)  TL_LOG_RATE_LIMITED(LogLevel::WARNING,  rate, burst, __VA_ARGS__)
+#define LOG_ERROR_RATE_LIMITED(rate, burst, ...)    TL_LOG_RATE_LIMITED(LogLevel::LERROR,   rate, burst, __VA_ARGS__)
+#define LOG_CRITICAL_RATE_LIMITED(rate, burst, ...) TL_LOG_RATE_LIMITED(LogLevel::CRITICAL, rate, burst, __VA_ARGS__)
+
+
+/*
+ * =========================================================================
+ *                         Formatted Logger Macros
+ * =========================================================================
+ *
+ * The LOG_<LEVEL>F macros take a format string literal, then its arguments,
+ * as LOG_INFOF("x={} y={:.3f}", x, y). See Compile-time Format Strings for
+ * the syntax of the fields. They expand to the matching LOG_<LEVEL> macro,
+ * and so are stripped with it under MAX_LOG_LEVEL_AT_COMPILATION.
+ *
+ * @param ... (variadic): Format string literal, followed by one argument of
+ *                        any streamable type per field.
+ */
+
+// Type whose static value() returns the format string, usable in constant expressions
+#define TL_FORMAT_STRING(format) \
+    ([]() { struct TlFormatString { static constexpr std::string_view value() { return format; } }; return TlFormatString(); }())
+
+#define TL_EXPAND(x) x
+#define TL_FIRST_ARGUMENT(first, ...) first
+#define TL_FORMAT_ARGUMENTS(...) \
+    tl::detail::formatMessage(TL_FORMAT_STRING(TL_EXPAND(TL_FIRST_ARGUMENT(__VA_ARGS__, unused))), __VA_ARGS__)
+
+#define LOG_TRACEF(...)    LOG_TRACE(TL_FORMAT_ARGUMENTS(__VA_ARGS__))
+#define LOG_DEBUGF(...)    LOG_DEBUG(TL_FORMAT_ARGUMENTS(__VA_ARGS__))
+#define LOG_VERBOSEF(...)  LOG_VERBOSE(TL_FORMAT_ARGUMENTS(__VA_ARGS__))
+#define LOG_INFOF(...)     LOG_INFO(TL_FORMAT_ARGUMENTS(__VA_ARGS__))
+#define LOG_WARNINGF(...)  LOG_WARNING(TL_FORMAT_ARGUMENTS(__VA_ARGS__))
+#define LOG_ERRORF(...)    LOG_ERROR(TL_FORMAT_ARGUMENTS(__VA_ARGS__))
+#define LOG_CRITICALF(...) LOG_CRITICAL(TL_FORMAT_ARGUMENTS(__VA_ARGS__))
+
+
+/*
+ * =========================================================================
+ *                        Structured Logger Macros
+ * =========================================================================
+ *
+ * The LOG_<LEVEL>_KV macros take a message, then fields built by tl::kv, as
+ * LOG_INFO_KV("request done", tl::kv("latency_us", x), tl::kv("status", s)).
+ * Records are written in the layout of Logger::setStructuredFormat, with
+ * the context of LOG_CONTEXT() as separate fields. See Structured Records.
+ *
+ * @param ... (variadic): Message of any streamable type, followed by fields.
+ */
+
+// Function, file and line of the expansion, as enabled by the LOG_* flags
+#define TL_SOURCE_LOCATION()                                                                         \
+    tl::detail::SourceLocation{ LOG_FUNCTION_NAME ? tl::StaticString(__FUNCTION__) : SSTR(""),         \
+                                LOG_FILE_NAME ? TL_STATIC_CONTEXT("", __FILE__, "") : SSTR(""),         \
+                                LOG_LINE_NUMBER ? static_cast<uint32_t>(__LINE__) : 0u }
+
+#define TL_LOG_STRUCTURED(logLevel, ...) \
+    TL_LOG_IF_ENABLED((logLevel), tl::detail::structuredMessage(logger.structuredFormat(), TL_SOURCE_LOCATION(), __VA_ARGS__))
+
+#define LOG_TRACE_KV(...)    TL_LOG_STRUCTURED(LogLevel::TRACE,    __VA_ARGS__)
+#define LOG_DEBUG_KV(...)    TL_LOG_STRUCTURED(LogLevel::DEBUG,    __VA_ARGS__)
+#define LOG_VERBOSE_KV(...)  TL_LOG_STRUCTURED(LogLevel::VERBOSE,  __VA_ARGS__)
+#define LOG_INFO_KV(...)     TL_LOG_STRUCTURED(LogLevel::INFO,     __VA_ARGS__)
+#define LOG_WARNING_KV(...)  TL_LOG_STRUCTURED(LogLevel::WARNING,  __VA_ARGS__)
+#define LOG_ERROR_KV(...)    TL_LOG_STRUCTURED(LogLevel::LERROR,   __VA_ARGS__)
+#define LOG_CRITICAL_KV(...) TL_LOG_STRUCTURED(LogLevel::CRITICAL, __VA_ARGS__)
+
+
+/*
+ * =========================================================================
+ *                           Scoped Timer Macros
+ * =========================================================================
+ *
+ * TL_SCOPED_TIMER("parse") measures the time until the end of the enclosing
+ * scope. Samples go to a histogram per thread and per macro expansion, and
+ * are summarised by Logger::reportTimers, in one line per timer.
+ *
+ * @param name: Name of the timer in the reports, evaluated only once.
+ */
+
+#define TL_CONCATENATE_(first, second) first##second
+#define TL_CONCATENATE(first, second)  TL_CONCATENATE_(first, second)
+
+#define TL_SCOPED_TIMER(name)                                                          \
+    static const tl::TimerSite TL_CONCATENATE(tlTimerSite, __LINE__)(name);           \
+    const tl::ScopedTimer      TL_CONCATENATE(tlScopedTimer, __LINE__)(TL_CONCATENATE(tlTimerSite, __LINE__))
+
+
 /*
  * =========================================================================
  *                          Logger Header Cleanup
@@ -571,40 +7244,110 @@ inline Logger logger(LogLevel::TRACE);
 #   undef  LOG_TRACE
     // Empty macro since the flag MAX_LOG_LEVEL_AT_COMPILATION is set below 7
 #   define LOG_TRACE(...)
+#   undef  LOG_TRACE_CAT
+#   define LOG_TRACE_CAT(...)
+#   undef  LOG_TRACE_EVERY_N
+#   define LOG_TRACE_EVERY_N(...)
+#   undef  LOG_TRACE_EVERY_MS
+#   define LOG_TRACE_EVERY_MS(...)
+#   undef  LOG_TRACE_RATE_LIMITED
+#   define LOG_TRACE_RATE_LIMITED(...)
+#   undef  LOG_TRACE_KV
+#   define LOG_TRACE_KV(...)
 #endif
 
 #if (MAX_LOG_LEVEL_AT_COMPILATION < 6)
 #   undef  LOG_DEBUG
     // Empty macro since the flag MAX_LOG_LEVEL_AT_COMPILATION is set below 6
 #   define LOG_DEBUG(...)
+#   undef  LOG_DEBUG_CAT
+#   define LOG_DEBUG_CAT(...)
+#   undef  LOG_DEBUG_EVERY_N
+#   define LOG_DEBUG_EVERY_N(...)
+#   undef  LOG_DEBUG_EVERY_MS
+#   define LOG_DEBUG_EVERY_MS(...)
+#   undef  LOG_DEBUG_RATE_LIMITED
+#   define LOG_DEBUG_RATE_LIMITED(...)
+#   undef  LOG_DEBUG_KV
+#   define LOG_DEBUG_KV(...)
 #endif
 
 #if (MAX_LOG_LEVEL_AT_COMPILATION < 5)
 #   undef  LOG_VERBOSE
     // Empty macro since the flag MAX_LOG_LEVEL_AT_COMPILATION is set below 5
 #   define LOG_VERBOSE(...)
+#   undef  LOG_VERBOSE_CAT
+#   define LOG_VERBOSE_CAT(...)
+#   undef  LOG_VERBOSE_EVERY_N
+#   define LOG_VERBOSE_EVERY_N(...)
+#   undef  LOG_VERBOSE_EVERY_MS
+#   define LOG_VERBOSE_EVERY_MS(...)
+#   undef  LOG_VERBOSE_RATE_LIMITED
+#   define LOG_VERBOSE_RATE_LIMITED(...)
+#   undef  LOG_VERBOSE_KV
+#   define LOG_VERBOSE_KV(...)
 #endif
 
 #if (MAX_LOG_LEVEL_AT_COMPILATION < 4)
 #   undef  LOG_INFO
     // Empty macro since the flag MAX_LOG_LEVEL_AT_COMPILATION is set below 4
 #   define LOG_INFO(...)
+#   undef  LOG_INFO_CAT
+#   define LOG_INFO_CAT(...)
+#   undef  LOG_INFO_EVERY_N
+#   define LOG_INFO_EVERY_N(...)
+#   undef  LOG_INFO_EVERY_MS
+#   define LOG_INFO_EVERY_MS(...)
+#   undef  LOG_INFO_RATE_LIMITED
+#   define LOG_INFO_RATE_LIMITED(...)
+#   undef  LOG_INFO_KV
+#   define LOG_INFO_KV(...)
 #endif
 
 #if (MAX_LOG_LEVEL_AT_COMPILATION < 3)
 #   undef  LOG_WARNING
     // Empty macro since the flag MAX_LOG_LEVEL_AT_COMPILATION is set below 3
 #   define LOG_WARNING(...)
+#   undef  LOG_WARNING_CAT
+#   define LOG_WARNING_CAT(...)
+#   undef  LOG_WARNING_EVERY_N
+#   define LOG_WARNING_EVERY_N(...)
+#   undef  LOG_WARNING_EVERY_MS
+#   define LOG_WARNING_EVERY_MS(...)
+#   undef  LOG_WARNING_RATE_LIMITED
+#   define LOG_WARNING_RATE_LIMITED(...)
+#   undef  LOG_WARNING_KV
+#   define LOG_WARNING_KV(...)
 #endif
 
 #if (MAX_LOG_LEVEL_AT_COMPILATION < 2)
 #   undef  LOG_ERROR
     // Empty macro since the flag MAX_LOG_LEVEL_AT_COMPILATION is set below 2
 #   define LOG_ERROR(...)
+#   undef  LOG_ERROR_CAT
+#   define LOG_ERROR_CAT(...)
+#   undef  LOG_ERROR_EVERY_N
+#   define LOG_ERROR_EVERY_N(...)
+#   undef  LOG_ERROR_EVERY_MS
+#   define LOG_ERROR_EVERY_MS(...)
+#   undef  LOG_ERROR_RATE_LIMITED
+#   define LOG_ERROR_RATE_LIMITED(...)
+#   undef  LOG_ERROR_KV
+#   define LOG_ERROR_KV(...)
 #endif
 
 #if (MAX_LOG_LEVEL_AT_COMPILATION < 1)
 #   undef  LOG_CRITICAL
     // Empty macro since the flag MAX_LOG_LEVEL_AT_COMPILATION is set below 1
 #   define LOG_CRITICAL(...)
+#   undef  LOG_CRITICAL_CAT
+#   define LOG_CRITICAL_CAT(...)
+#   undef  LOG_CRITICAL_EVERY_N
+#   define LOG_CRITICAL_EVERY_N(...)
+#   undef  LOG_CRITICAL_EVERY_MS
+#   define LOG_CRITICAL_EVERY_MS(...)
+#   undef  LOG_CRITICAL_RATE_LIMITED
+#   define LOG_CRITICAL_RATE_LIMITED(...)
+#   undef  LOG_CRITICAL_KV
+#   define LOG_CRITICAL_KV(...)
 #endif
\ No newline at end of file
@@ -0,0 +1,15 @@
+/*
+ * ============================================================================
+ *                          TinyLogger Library Source
+ * ============================================================================
+ *
+ * Compiles the backend of the logger once, for the programs built with
+ * TINYLOGGER_COMPILED set to 1, as the tinylogger CMake target does. The
+ * logging functions of the header then only pack their arguments, and call
+ * the functions defined here.
+ */
+
+
+#define TINYLOGGER_IMPLEMENTATION
+
+#include <tinylogger/tinylogger.hpp>
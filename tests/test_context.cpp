@@ -0,0 +1,44 @@
+#include <gtest/gtest.h>
+
+// Context macros only change the expansion of LOG_CONTEXT, so this file can
+// pick other values than the test_tinylogger.cpp one in the same executable
+#define LOG_FUNCTION_NAME 1
+#define LOG_FILE_NAME     1
+#define LOG_LINE_NUMBER   1
+
+#include <tinylogger/tinylogger.hpp>
+
+#include <string>
+
+namespace {
+
+    int logLine = 0;
+
+    void logWithContext(int i) {
+        logLine = __LINE__ + 1;
+        LOG_WARNING("context ", i);
+    }
+
+} // namespace
+
+TEST(TinyLoggerTest, ContextJoinsFunctionBaseNameAndLine) {
+	auto sink = std::make_shared<tl::MemorySink>(4);
+	logger.addSink(sink);
+
+	logWithContext(1);
+	logWithContext(2);
+
+	logger.removeSink(sink);
+	ASSERT_EQ(sink->lines().size(), 2u);
+
+	const std::string context = "logWithContext: in [test_context.cpp] (l. " + std::to_string(logLine) + ") ";
+	EXPECT_NE(sink->lines()[0].find(context + "context 1"), std::string::npos);
+	EXPECT_NE(sink->lines()[1].find(context + "context 2"), std::string::npos);
+	EXPECT_EQ(sink->lines()[0].find("tests/"), std::string::npos);
+}
+
+TEST(TinyLoggerTest, ContextIsJoinedDuringTheCompilation) {
+	constexpr auto context = tl::detail::joinContext(" in [", "a/b\\c.cpp", "] ");
+	static_assert(context.size == 12, "directories are removed from the file");
+	EXPECT_EQ(std::string(context.data, context.size), " in [c.cpp] ");
+}
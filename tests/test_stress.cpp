@@ -0,0 +1,270 @@
+#include <gtest/gtest.h>
+
+#include <tinylogger/tinylogger.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Latency bounds are only meaningful without the instrumentation of a sanitizer
+#if defined(__SANITIZE_THREAD__) || defined(__SANITIZE_ADDRESS__)
+    #define IS_TINYLOGGER_SANITIZED 1
+#elif defined(__has_feature)
+    #if __has_feature(thread_sanitizer) || __has_feature(address_sanitizer)
+        #define IS_TINYLOGGER_SANITIZED 1
+    #endif
+#endif
+
+#ifndef IS_TINYLOGGER_SANITIZED
+    #define IS_TINYLOGGER_SANITIZED 0
+#endif
+
+namespace {
+
+    // Keeps every line, unlike the ring of tl::MemorySink
+    class CollectingSink : public tl::Sink {
+    public:
+        void write(LogLevel, std::string_view line) override {
+            std::lock_guard<std::mutex> guard(mutex_);
+            lines_.emplace_back(line);
+        }
+
+        std::vector<std::string> lines() const {
+            std::lock_guard<std::mutex> guard(mutex_);
+            return lines_;
+        }
+
+    private:
+        mutable std::mutex       mutex_;
+        std::vector<std::string> lines_;
+    };
+
+    // Discards the lines, so that only the cost of the logger is measured
+    class NullSink : public tl::Sink {
+    public:
+        void write(LogLevel, std::string_view line) override {
+            size_.fetch_add(line.size(), std::memory_order_relaxed);
+        }
+
+    private:
+        std::atomic<size_t> size_{ 0 };
+    };
+
+    const int threadCount      = 8;
+    const int recordsPerThread = IS_TINYLOGGER_SANITIZED ? 500 : 2000;
+
+    // Length and letter depend on the record, so that a line mixing two records shows up
+    std::string payloadOf(int thread, int index) {
+        return std::string(static_cast<size_t>(index % 61 + 1), static_cast<char>('a' + thread));
+    }
+
+    /*
+     * Logs WARNING records from every thread, while the level is changed
+     * between WARNING and TRACE, flags are added and released, a progress
+     * bar is drawn by the first thread, and DEBUG records come and go with
+     * the level. None of those can filter out a WARNING record.
+     */
+    void hammer(Logger& stressed) {
+        std::atomic<bool> isDone{ false };
+        std::thread levels([&]() {
+            const LogLevel cycle[] = { LogLevel::WARNING, LogLevel::TRACE, LogLevel::INFO, LogLevel::DEBUG };
+            for (size_t i = 0; !isDone.load(std::memory_order_relaxed); ++i) {
+                stressed.setLogLevel(cycle[i % 4]);
+                std::this_thread::yield();
+            }
+        });
+
+        std::vector<std::thread> threads;
+        for (int thread = 0; thread < threadCount; ++thread) {
+            threads.emplace_back([&stressed, thread]() {
+                const std::string flag = "stress " + std::to_string(thread);
+                for (int index = 0; index < recordsPerThread; ++index) {
+                    if (index % 100 == 0)
+                        stressed.addFlag(flag);
+                    stressed.log(LogLevel::WARNING, "stress ", thread, ' ', index, ' ', payloadOf(thread, index));
+                    stressed.log(LogLevel::DEBUG, "noise ", thread, ' ', index);
+                    if (index % 100 == 99)
+                        stressed.releaseFlag(flag);
+                    if (thread == 0)
+                        stressed.displayProgressBar(static_cast<size_t>(index), static_cast<size_t>(recordsPerThread));
+                }
+            });
+        }
+
+        for (std::thread& thread : threads)
+            thread.join();
+        isDone.store(true, std::memory_order_relaxed);
+        levels.join();
+        stressed.flush();
+    }
+
+    // Every WARNING record is written once, whole, and in the order of its thread
+    void expectEveryRecord(const std::vector<std::string>& lines) {
+        std::vector<std::vector<int>> indices(threadCount);
+        for (const std::string& line : lines) {
+            const size_t start = line.find("stress ");
+            if (start == std::string::npos || line.find("Flag '") != std::string::npos)
+                continue;
+
+            std::istringstream fields(line.substr(start + 7));
+            int         thread = -1;
+            int         index  = -1;
+            std::string payload;
+            fields >> thread >> index >> payload;
+            ASSERT_TRUE(thread >= 0 && thread < threadCount) << line;
+            EXPECT_EQ(payload, payloadOf(thread, index)) << line;
+            EXPECT_EQ(line.back(), '\n') << line;
+            EXPECT_EQ(std::count(line.begin(), line.end(), '\n'), 1) << line;
+            indices[static_cast<size_t>(thread)].push_back(index);
+        }
+
+        for (int thread = 0; thread < threadCount; ++thread) {
+            const std::vector<int>& received = indices[static_cast<size_t>(thread)];
+            ASSERT_EQ(received.size(), static_cast<size_t>(recordsPerThread)) << "thread " << thread;
+            for (int index = 0; index < recordsPerThread; ++index)
+                ASSERT_EQ(received[static_cast<size_t>(index)], index) << "thread " << thread;
+        }
+    }
+
+    // Percentile of the time taken by a call, in nanoseconds
+    int64_t percentile(std::vector<int64_t> samples, double rank) {
+        std::sort(samples.begin(), samples.end());
+        return samples[std::min(samples.size() - 1, static_cast<size_t>(rank * static_cast<double>(samples.size())))];
+    }
+
+    std::vector<int64_t> measureLatencies(Logger& stressed, int count) {
+        using Clock = std::chrono::steady_clock;
+
+        std::vector<int64_t> samples;
+        samples.reserve(static_cast<size_t>(count));
+        for (int i = 0; i < count; ++i) {
+            const Clock::time_point start = Clock::now();
+            stressed.log(LogLevel::WARNING, "request ", i, " served in ", i * 0.25, " ms by ", "worker");
+            const Clock::time_point end   = Clock::now();
+            samples.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+        }
+        return samples;
+    }
+
+    /*
+     * Reads the committed baseline, one "<name> <p99.9 in nanoseconds>" per
+     * line, names ending with the binary and the build type they were
+     * measured with.
+     */
+    std::map<std::string, int64_t> readBaseline() {
+        std::map<std::string, int64_t> baseline;
+        std::ifstream                  file(TINYLOGGER_LATENCY_BASELINE);
+        std::string                    line;
+        while (std::getline(file, line)) {
+            std::istringstream fields(line);
+            std::string        name;
+            int64_t            nanoseconds = 0;
+            if (!line.empty() && line[0] != '#' && fields >> name >> nanoseconds)
+                baseline[name] = nanoseconds;
+        }
+        return baseline;
+    }
+
+#ifdef NDEBUG
+    const char* const buildType = "release";
+#else
+    const char* const buildType = "debug";
+#endif
+
+#if TINYLOGGER_COMPILED
+    const char* const binary = "compiled";
+#else
+    const char* const binary = "header";
+#endif
+
+    // Margin for the machines running the tests, slower or busier than the one of the baseline
+    const int64_t latencyTolerance = 4;
+
+} // namespace
+
+TEST(TinyLoggerStressTest, SyncRecordsAreNeitherLostNorInterleaved) {
+	Logger localLogger(LogLevel::WARNING);
+	auto sink = std::make_shared<CollectingSink>();
+	localLogger.clearSinks();
+	localLogger.addSink(sink);
+
+	hammer(localLogger);
+	expectEveryRecord(sink->lines());
+}
+
+TEST(TinyLoggerStressTest, AsyncRecordsAreNeitherLostNorInterleaved) {
+	Logger localLogger(LogLevel::WARNING);
+	auto sink = std::make_shared<CollectingSink>();
+	localLogger.clearSinks();
+	localLogger.addSink(sink);
+
+	AsyncOptions options;
+	options.queueCapacity = 256;
+	localLogger.startAsync(options);
+	hammer(localLogger);
+	localLogger.stopAsync();
+	expectEveryRecord(sink->lines());
+}
+
+TEST(TinyLoggerStressTest, ThreadQueueRecordsAreNeitherLostNorInterleaved) {
+	Logger localLogger(LogLevel::WARNING);
+	auto sink = std::make_shared<CollectingSink>();
+	localLogger.clearSinks();
+	localLogger.addSink(sink);
+
+	AsyncOptions options;
+	options.threadQueues        = true;
+	options.threadQueueCapacity = 64;
+	localLogger.startAsync(options);
+	hammer(localLogger);
+	localLogger.stopAsync();
+	expectEveryRecord(sink->lines());
+}
+
+TEST(TinyLoggerStressTest, TailLatencyStaysWithinBaseline) {
+	if (IS_TINYLOGGER_SANITIZED)
+		GTEST_SKIP() << "latency is not meaningful under a sanitizer";
+
+	// Absolute times only mean something on a machine like the one of the baseline
+	if (!std::getenv("TINYLOGGER_LATENCY_TESTS"))
+		GTEST_SKIP() << "set TINYLOGGER_LATENCY_TESTS to compare the latency with the baseline";
+
+	const std::map<std::string, int64_t> baseline = readBaseline();
+	ASSERT_FALSE(baseline.empty()) << "could not read " << TINYLOGGER_LATENCY_BASELINE;
+
+	Logger localLogger(LogLevel::WARNING);
+	localLogger.clearSinks();
+	localLogger.addSink(std::make_shared<NullSink>());
+
+	// Best of a few rounds, so that a preemption of the test does not fail it
+	const auto expectWithinBaseline = [&](const std::string& path) {
+		const std::string name     = path + '.' + binary + '.' + buildType;
+		const auto        iterator = baseline.find(name);
+		ASSERT_NE(iterator, baseline.end()) << "no baseline for " << name;
+
+		measureLatencies(localLogger, 1000);
+		int64_t measured = std::numeric_limits<int64_t>::max();
+		for (int round = 0; round < 3; ++round)
+			measured = std::min(measured, percentile(measureLatencies(localLogger, 10000), 0.999));
+
+		RecordProperty(name + ".p99.9_ns", std::to_string(measured));
+		EXPECT_LE(measured, iterator->second * latencyTolerance)
+			<< name << ": p99.9 of " << measured << " ns, baseline of " << iterator->second << " ns";
+	};
+
+	expectWithinBaseline("sync");
+
+	localLogger.startAsync();
+	expectWithinBaseline("async");
+	localLogger.flush();
+	localLogger.stopAsync();
+}
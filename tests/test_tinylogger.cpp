@@ -1,6 +1,14 @@
 #include <gtest/gtest.h>
 
 #include <tinylogger/tinylogger.hpp>
+#include <tinylogger/binary_decoder.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <regex>
+#include <thread>
 
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
@@ -10,4 +18,1179 @@ int main(int argc, char** argv) {
 TEST(TinyLoggerTest, LogsToCout) {
 	logger.log(LogLevel::TRACE, "This is a test log message. ", 1, 3.0, std::string("yes"), " I am");
 	EXPECT_TRUE(true);
-}
\ No newline at end of file
+}
+
+TEST(TinyLoggerTest, AsyncModeWritesEveryRecordAfterFlush) {
+	std::ostringstream captured;
+	std::streambuf* original = std::cout.rdbuf(captured.rdbuf());
+
+	logger.startAsync();
+	for (int i = 0; i < 1000; ++i)
+		logger.logINFO("record ", i);
+	logger.flush();
+	logger.stopAsync();
+
+	std::cout.rdbuf(original);
+
+	std::string output = captured.str();
+	EXPECT_EQ(std::count(output.begin(), output.end(), '\n'), 1000);
+	EXPECT_NE(output.find("record 999\n"), std::string::npos);
+}
+
+TEST(TinyLoggerTest, AsyncModeAccountsForDroppedRecords) {
+	std::ostringstream captured;
+	std::streambuf* original = std::cout.rdbuf(captured.rdbuf());
+
+	AsyncOptions options;
+	options.queueCapacity  = 4;
+	options.overflowPolicy = OverflowPolicy::DROP_NEWEST;
+
+	const size_t droppedBefore = logger.droppedRecords();
+	logger.startAsync(options);
+	for (int i = 0; i < 10000; ++i)
+		logger.logINFO("record ", i);
+	logger.stopAsync();
+
+	std::cout.rdbuf(original);
+
+	std::string output  = captured.str();
+	size_t      written = static_cast<size_t>(std::count(output.begin(), output.end(), '\n'));
+	EXPECT_EQ(written + logger.droppedRecords() - droppedBefore, 10000u);
+}
+
+TEST(TinyLoggerTest, AsyncModeDefersArgumentsFormatting) {
+	std::ostringstream captured;
+	std::streambuf* original = std::cout.rdbuf(captured.rdbuf());
+
+	logger.startAsync();
+	{
+		// Arguments are copied, so they may be destroyed before being written
+		std::string temporary = "copied";
+		LOG_INFO("deferred ", 42, ' ', 2.5, ' ', temporary, ' ', std::string_view("view"));
+		LOG_INFO("too large ", std::string(2 * TINYLOGGER_PAYLOAD_SIZE, 'x'));
+	}
+	logger.stopAsync();
+
+	std::cout.rdbuf(original);
+
+	std::string output = captured.str();
+	EXPECT_NE(output.find("deferred 42 2.5 copied view\n"), std::string::npos);
+	EXPECT_NE(output.find("too large " + std::string(2 * TINYLOGGER_PAYLOAD_SIZE, 'x') + "\n"), std::string::npos);
+}
+
+TEST(TinyLoggerTest, TimestampCacheMatchesCtimeLayout) {
+	tl::detail::TimestampCache cache;
+
+	for (time_t instant : { time_t(0), time_t(1760428233), time_t(1760428234), time_t(1767225599) }) {
+		char expected[26];
+		#ifdef _WIN32
+			ctime_s(expected, sizeof(expected), &instant); expected[24] = '\0';
+		#else
+			ctime_r(&instant, expected); expected[24] = '\0';
+		#endif
+
+		auto time = std::chrono::system_clock::from_time_t(instant) + std::chrono::microseconds(123456);
+		EXPECT_EQ(cache.render(time, TimestampFormat::CTIME, TimestampPrecision::SECONDS), std::string_view(expected));
+
+		std::string withMilliseconds(expected);
+		withMilliseconds.insert(19, ".123");
+		EXPECT_EQ(cache.render(time, TimestampFormat::CTIME, TimestampPrecision::MILLISECONDS), withMilliseconds);
+	}
+}
+
+TEST(TinyLoggerTest, TimestampCanBeIso8601WithMicroseconds) {
+	std::ostringstream captured;
+	std::streambuf* original = std::cout.rdbuf(captured.rdbuf());
+
+	logger.setTimestampFormat(TimestampFormat::ISO8601, TimestampPrecision::MICROSECONDS);
+	logger.logINFO("iso");
+	logger.setTimestampFormat(TimestampFormat::CTIME);
+
+	std::cout.rdbuf(original);
+
+	std::regex layout(R"(\[INFO\]     \d{4}-\d{2}-\d{2}T\d{2}:\d{2}:\d{2}\.\d{6}[+-]\d{4} \+\d+\.\d{6} s iso\n)");
+	EXPECT_TRUE(std::regex_match(captured.str(), layout)) << captured.str();
+}
+
+TEST(TinyLoggerTest, FormatBufferMatchesStreamOutput) {
+	tl::detail::FormatBuffer buffer;
+	std::ostringstream       expected;
+
+	auto check = [&](const auto& value) {
+		buffer.clear();
+		expected.str("");
+		tl::detail::appendArgument(buffer, value);
+		expected << value;
+		EXPECT_EQ(buffer.view(), expected.str());
+	};
+
+	check(true); check('c'); check(-42); check(18446744073709551615ull);
+	check(2.5); check(1.0 / 3.0); check(1e300); check(-0.000012345f);
+	check("literal"); check(std::string("string")); check(std::string_view("view"));
+}
+
+TEST(TinyLoggerTest, FormatBufferFallsBackOnHeapForLongLines) {
+	tl::detail::FormatBuffer buffer;
+	const size_t fallbacksBefore = logger.formatHeapFallbacks();
+
+	std::string longLine(3 * TINYLOGGER_FORMAT_BUFFER_SIZE, 'x');
+	buffer.append("start ");
+	buffer.append(longLine);
+	tl::detail::appendArgument(buffer, 7);
+
+	EXPECT_EQ(buffer.view(), "start " + longLine + "7");
+	EXPECT_EQ(logger.formatHeapFallbacks(), fallbacksBefore + 1);
+}
+
+TEST(TinyLoggerTest, FileSinkBuffersUntilFlushLevel) {
+	const std::filesystem::path path = std::filesystem::temp_directory_path() / "tinylogger_file_sink.log";
+	std::filesystem::remove(path);
+
+	auto readFile = [&]() {
+		std::ifstream file(path, std::ios::binary);
+		return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	};
+
+	{
+		tl::FileSinkOptions options;
+		options.flushInterval = std::chrono::milliseconds(0);
+		options.flushLevel    = LogLevel::LERROR;
+
+		tl::FileSink sink(path, options);
+		ASSERT_TRUE(sink.isOpen());
+
+		sink.write(LogLevel::TRACE, "trace line\n");
+		EXPECT_EQ(readFile(), "");
+
+		sink.write(LogLevel::LERROR, "error line\n");
+		EXPECT_EQ(readFile(), "trace line\nerror line\n");
+
+		sink.write(LogLevel::INFO, "info line\n");
+	}
+
+	// Remaining lines are written when the sink is destroyed
+	EXPECT_EQ(readFile(), "trace line\nerror line\ninfo line\n");
+	std::filesystem::remove(path);
+}
+
+TEST(TinyLoggerTest, SinksFilterLevelsIndependently) {
+	auto everything = std::make_shared<tl::MemorySink>(8);
+	auto errorsOnly = std::make_shared<tl::MemorySink>(8);
+	errorsOnly->setLogLevel(LogLevel::LERROR);
+
+	Logger localLogger(LogLevel::TRACE);
+	localLogger.clearSinks();
+	localLogger.addSink(everything);
+	localLogger.addSink(errorsOnly);
+
+	localLogger.logDEBUG("debug line");
+	localLogger.logERROR("error line");
+
+	std::vector<std::string> allLines   = everything->lines();
+	std::vector<std::string> errorLines = errorsOnly->lines();
+	ASSERT_EQ(allLines.size(), 2u);
+	ASSERT_EQ(errorLines.size(), 1u);
+	EXPECT_EQ(allLines[1], errorLines[0]);
+	EXPECT_EQ(errorLines[0].rfind("[ERROR]", 0), 0u);
+}
+
+TEST(TinyLoggerTest, MemorySinkKeepsMostRecentLines) {
+	tl::MemorySink sink(2);
+	sink.write(LogLevel::INFO, "first\n");
+	sink.write(LogLevel::INFO, "second\n");
+	sink.write(LogLevel::INFO, "third\n");
+
+	EXPECT_EQ(sink.lines(), (std::vector<std::string>{ "second\n", "third\n" }));
+}
+
+TEST(TinyLoggerTest, BackgroundSinkWritesLinesOnFlush) {
+	auto memory     = std::make_shared<tl::MemorySink>(1000);
+	auto background = std::make_shared<tl::BackgroundSink>(memory);
+
+	Logger localLogger(LogLevel::TRACE);
+	localLogger.clearSinks();
+	localLogger.addSink(background);
+	for (int i = 0; i < 100; ++i)
+		localLogger.logINFO("line ", i);
+	localLogger.flush();
+
+	EXPECT_EQ(memory->lines().size() + background->droppedLines(), 100u);
+}
+
+TEST(TinyLoggerTest, RotatingFileSinkKeepsBoundedNumberOfSegments) {
+	const std::filesystem::path directory = std::filesystem::temp_directory_path() / "tinylogger_rotation";
+	std::filesystem::remove_all(directory);
+	std::filesystem::create_directories(directory);
+
+	tl::RotatingFileSinkOptions options;
+	options.maxFileSize = 100;
+	options.maxFiles    = 2;
+
+	std::string expectedLastLine;
+	{
+		tl::RotatingFileSink sink(directory / "app.log", options);
+		ASSERT_TRUE(sink.isOpen());
+
+		for (int i = 0; i < 20; ++i) {
+			expectedLastLine = "line number " + std::to_string(i) + " of the rotation test\n";
+			sink.write(LogLevel::INFO, expectedLastLine);
+		}
+	}
+
+	size_t segments = 0;
+	for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+		EXPECT_EQ(entry.path().filename().string().rfind("app.", 0), 0u);
+		EXPECT_LE(std::filesystem::file_size(entry.path()), options.maxFileSize);
+		++segments;
+	}
+
+	// Closed segments kept, plus the one that was active at destruction
+	EXPECT_EQ(segments, options.maxFiles + 1);
+	std::filesystem::remove_all(directory);
+}
+
+TEST(TinyLoggerTest, MappedFileSinkRollsAndTruncatesSegments) {
+	const std::filesystem::path directory = std::filesystem::temp_directory_path() / "tinylogger_mapped";
+	std::filesystem::remove_all(directory);
+	std::filesystem::create_directories(directory);
+
+	tl::MappedFileSinkOptions options;
+	options.segmentSize = 4096;
+
+	const std::string line = std::string(2047, 'x') + '\n';
+	{
+		tl::MappedFileSink sink(directory / "trace.log", options);
+		ASSERT_TRUE(sink.isOpen());
+		for (int i = 0; i < 5; ++i)
+			sink.write(LogLevel::TRACE, line);
+	}
+
+	// Two lines fit in every segment, the last one holds a single line
+	auto readFile = [](const std::filesystem::path& path) {
+		std::ifstream file(path, std::ios::binary);
+		return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	};
+	EXPECT_EQ(readFile(directory / "trace.000001.log"), line + line);
+	EXPECT_EQ(readFile(directory / "trace.000002.log"), line + line);
+	EXPECT_EQ(readFile(directory / "trace.000003.log"), line);
+
+	// Segments smaller than a page are raised to a page
+	options.segmentSize = 0;
+	{
+		tl::MappedFileSink sink(directory / "small.log", options);
+		ASSERT_TRUE(sink.isOpen());
+		sink.write(LogLevel::TRACE, line);
+		sink.write(LogLevel::TRACE, line);
+	}
+	EXPECT_EQ(readFile(directory / "small.000001.log"), line + line);
+	EXPECT_FALSE(std::filesystem::exists(directory / "small.000002.log"));
+	std::filesystem::remove_all(directory);
+}
+
+TEST(TinyLoggerTest, MappedFileSinkDropsLinesUntilASegmentCanBeCreated) {
+	const std::filesystem::path directory = std::filesystem::temp_directory_path() / "tinylogger_mapped_failed";
+	std::filesystem::remove_all(directory);
+
+	tl::MappedFileSinkOptions options;
+	options.segmentSize   = 4096;
+	options.retryInterval = std::chrono::milliseconds(200);
+
+	{
+		// The directory is missing, so that no segment can be created
+		tl::MappedFileSink sink(directory / "trace.log", options);
+		EXPECT_FALSE(sink.isOpen());
+		EXPECT_TRUE(sink.currentPath().empty());
+
+		const std::string line = "line\n";
+		for (int i = 0; i < 3; ++i)
+			sink.write(LogLevel::TRACE, line);
+		tl::SinkStats stats;
+		sink.describeStats(stats);
+		EXPECT_EQ(stats.dropped, 3u);
+
+		// No attempt is made before the retry interval, even once the directory exists
+		std::filesystem::create_directories(directory);
+		sink.write(LogLevel::TRACE, line);
+		EXPECT_FALSE(sink.isOpen());
+		EXPECT_TRUE(std::filesystem::is_empty(directory));
+
+		std::this_thread::sleep_for(options.retryInterval);
+		sink.write(LogLevel::TRACE, line);
+		ASSERT_TRUE(sink.isOpen());
+		EXPECT_EQ(sink.currentPath(), directory / "trace.000001.log");
+		sink.describeStats(stats);
+		EXPECT_EQ(stats.dropped, 4u);
+	}
+	std::filesystem::remove_all(directory);
+}
+
+TEST(TinyLoggerTest, BinaryFileSinkDecodesToTextLines) {
+	const std::filesystem::path path = std::filesystem::temp_directory_path() / "tinylogger_binary.tlb";
+	std::filesystem::remove(path);
+
+	auto text = std::make_shared<tl::MemorySink>(8);
+	{
+		auto binary = std::make_shared<tl::BinaryFileSink>(path);
+		ASSERT_TRUE(binary->isOpen());
+
+		Logger localLogger(LogLevel::TRACE);
+		localLogger.clearSinks();
+		localLogger.addSink(binary);
+		localLogger.addSink(text);
+
+		localLogger.logINFO("integers ", -42, ' ', 7u, ' ', uint64_t(1) << 40);
+		localLogger.logWARNING("floating ", 3.25, ' ', 0.1f, ' ', true);
+		localLogger.logDEBUG("text ", std::string("owned"), ' ', std::string_view("viewed"));
+		localLogger.logERROR(LOG_CONTEXT(), "with context");
+		localLogger.logINFO(TL_FORMAT_ARGUMENTS("formatted {} {:.2f} {:>4}|", 1, 2.5, "x"));
+		localLogger.flush();
+	}
+
+	std::ifstream file(path, std::ios::binary);
+	std::ostringstream decoded;
+	ASSERT_TRUE(tl::decodeBinaryLog(file, decoded));
+
+	std::vector<std::string> decodedLines;
+	std::istringstream lines(decoded.str());
+	for (std::string line; std::getline(lines, line);)
+		decodedLines.push_back(line + "\n");
+
+	// The first record has no previous one in the file, hence its elapsed time
+	const std::vector<std::string> textLines = text->lines();
+	ASSERT_EQ(decodedLines.size(), textLines.size());
+	EXPECT_EQ(decodedLines[0].substr(decodedLines[0].find(" s ")), textLines[0].substr(textLines[0].find(" s ")));
+	for (size_t i = 1; i < textLines.size(); ++i)
+		EXPECT_EQ(decodedLines[i], textLines[i]);
+	std::filesystem::remove(path);
+
+	// A corrupt string size is rejected instead of being allocated
+	std::istringstream corrupt(std::string("TLOGBIN1S\x01\xff\xff\xff\xff\xff\xff\xff\xff\x7f", 19));
+	std::ostringstream ignored;
+	EXPECT_FALSE(tl::decodeBinaryLog(corrupt, ignored));
+}
+
+TEST(TinyLoggerTest, DisabledCallSiteSkipsArgumentsEvaluation) {
+	auto sink = std::make_shared<tl::MemorySink>(4);
+	logger.addSink(sink);
+
+	int evaluations = 0;
+	auto logDebug = [&evaluations]() { LOG_DEBUG("evaluation ", ++evaluations); };
+
+	logger.setLogLevel(LogLevel::WARNING);
+	logDebug();
+	logDebug();
+	EXPECT_EQ(evaluations, 0);
+
+	// The cached answer of the call site is invalidated by every change
+	logger.setLogLevel(LogLevel::TRACE);
+	logDebug();
+	EXPECT_EQ(evaluations, 1);
+
+	logger.setLogLevel(LogLevel::INFO);
+	logDebug();
+	EXPECT_EQ(evaluations, 1);
+
+	logger.setLogLevel(LogLevel::TRACE);
+	logger.removeSink(sink);
+	ASSERT_EQ(sink->lines().size(), 1u);
+	EXPECT_NE(sink->lines()[0].find("evaluation 1"), std::string::npos);
+
+	// The default context is the function name alone, without a line number
+	EXPECT_NE(sink->lines()[0].find("operator(): evaluation 1"), std::string::npos);
+	EXPECT_EQ(sink->lines()[0].find("(l. "), std::string::npos);
+}
+
+TEST(TinyLoggerTest, CategoriesHaveIndependentLevelsAndSinks) {
+	auto network = std::make_shared<tl::MemorySink>(8);
+	auto global  = std::make_shared<tl::MemorySink>(8);
+
+	tl::Category& category = TL_CATEGORY(net);
+	EXPECT_EQ(&category, &logger.category("net"));
+	logger.addSink(category, network);
+	logger.addSink(global);
+
+	logger.setLogLevel(LogLevel::WARNING);
+	category.setLogLevel(LogLevel::TRACE);
+
+	LOG_DEBUG_CAT(net, "packet ", 42);
+	LOG_DEBUG("not written");
+	LOG_WARNING("written");
+
+	category.setLogLevel(LogLevel::LERROR);
+	LOG_INFO_CAT(net, "filtered out");
+
+	logger.setLogLevel(LogLevel::TRACE);
+	logger.removeSink(category, network);
+	logger.removeSink(global);
+
+	// The category only writes to its own sink, once it has one
+	ASSERT_EQ(network->lines().size(), 1u);
+	EXPECT_NE(network->lines()[0].find("[net] "), std::string::npos);
+	EXPECT_NE(network->lines()[0].find("packet 42"), std::string::npos);
+	ASSERT_EQ(global->lines().size(), 1u);
+	EXPECT_NE(global->lines()[0].find("written"), std::string::npos);
+}
+
+TEST(TinyLoggerTest, TickClockIsCalibratedOnSystemClock) {
+	tl::detail::ClockCalibration calibration;
+
+	const uint64_t before = tl::detail::TickClock::now();
+	const auto     time   = calibration.toSystemTime(tl::detail::TickClock::now());
+	const auto     now    = std::chrono::system_clock::now();
+	EXPECT_GE(tl::detail::TickClock::now(), before);
+	EXPECT_GT(tl::detail::TickClock::nanosecondsPerTick(), 0.0);
+	EXPECT_LT(std::chrono::abs(now - time), std::chrono::milliseconds(5));
+
+	// Later ticks convert to later times, without reading the system clock
+	const auto later = calibration.toSystemTime(tl::detail::TickClock::now() + static_cast<uint64_t>(1e6 / tl::detail::TickClock::nanosecondsPerTick()));
+	EXPECT_GE(later - time, std::chrono::microseconds(900));
+	EXPECT_LT(later - time, std::chrono::milliseconds(5));
+}
+
+TEST(TinyLoggerTest, ScopedTimersReportMergedHistograms) {
+	using tl::detail::TimerHistogram;
+	for (uint64_t value : { 0ull, 15ull, 16ull, 1000ull, 123456789ull, 1ull << 40 }) {
+		const uint64_t highest = TimerHistogram::highestOf(TimerHistogram::bucketOf(value));
+		EXPECT_GE(highest, value);
+		EXPECT_LE(highest, value + value / 15);
+	}
+
+	auto sink = std::make_shared<tl::MemorySink>(8);
+	logger.addSink(sink);
+	logger.setTimerReportInterval(std::chrono::nanoseconds(0));
+
+	const auto timed = []() {
+		TL_SCOPED_TIMER("timed section");
+		std::this_thread::sleep_for(std::chrono::microseconds(100));
+	};
+	for (int i = 0; i < 20; ++i)
+		timed();
+
+	// The samples of an exited thread are kept by the timer site
+	std::thread([&timed]() {
+		for (int i = 0; i < 10; ++i)
+			timed();
+	}).join();
+
+	logger.reportTimers();
+	logger.reportTimers();
+	logger.setTimerReportInterval(std::chrono::seconds(10));
+	logger.removeSink(sink);
+
+	ASSERT_EQ(sink->lines().size(), 1u);
+	EXPECT_TRUE(std::regex_search(sink->lines()[0], std::regex(
+		"Timer 'timed section': count=30 p50=[0-9.]+ (us|ms) p99=[0-9.]+ (us|ms) p999=[0-9.]+ (us|ms) max=[0-9.]+ (us|ms)\n$")));
+}
+
+TEST(TinyLoggerTest, RateLimitedMacrosReportSuppressedCalls) {
+	auto sink = std::make_shared<tl::MemorySink>(16);
+	logger.addSink(sink);
+
+	for (int i = 0; i < 10; ++i)
+		LOG_WARNING_EVERY_N(4, "every fourth ", i);
+	for (int i = 0; i < 10; ++i)
+		LOG_WARNING_RATE_LIMITED(0.001, 3, "burst ", i);
+	for (int i = 0; i < 3; ++i) {
+		LOG_WARNING_EVERY_MS(20, "interval ", i);
+		if (i == 1)
+			std::this_thread::sleep_for(std::chrono::milliseconds(30));
+	}
+
+	logger.removeSink(sink);
+
+	std::vector<std::string> messages;
+	for (const std::string& line : sink->lines())
+		messages.push_back(line.substr(line.find(": ") + 2));
+	const std::vector<std::string> expected = {
+		"every fourth 0\n", "every fourth 4 (3 suppressed)\n", "every fourth 8 (3 suppressed)\n",
+		"burst 0\n", "burst 1\n", "burst 2\n",
+		"interval 0\n", "interval 2 (1 suppressed)\n"
+	};
+	EXPECT_EQ(messages, expected);
+}
+
+TEST(TinyLoggerTest, ProgressBarsCountIterationsOfAllThreads) {
+	std::ostringstream captured;
+	std::streambuf* original = std::cout.rdbuf(captured.rdbuf());
+
+	{
+		tl::ProgressBar copy("copy", 4000);
+		std::vector<std::thread> workers;
+		for (int i = 0; i < 4; ++i)
+			workers.emplace_back([&copy]() {
+				for (int j = 0; j < 1000; ++j)
+					copy.advance();
+			});
+		for (std::thread& worker : workers)
+			worker.join();
+
+		EXPECT_EQ(copy.completed(), 4000u);
+		EXPECT_NE(copy.render(tl::detail::TickClock::now()).find("copy [==============================] 100% "), std::string::npos);
+	}
+
+	// A single iteration used to divide by zero
+	logger.displayProgressBar(0, 1);
+
+	std::cout.rdbuf(original);
+
+	const std::string output = captured.str();
+	EXPECT_NE(output.find("copy [==============================] 100% "), std::string::npos);
+	EXPECT_NE(output.find("ETA 0:00:00"), std::string::npos);
+	EXPECT_NE(output.find("\r[==============================] 100% "), std::string::npos);
+}
+
+TEST(TinyLoggerTest, ProgressBarIsDisplayedFromParallelLoops) {
+	std::ostringstream captured;
+	std::streambuf* original = std::cout.rdbuf(captured.rdbuf());
+
+	// Threads report interleaved indices, finishing out of order
+	Logger localLogger(LogLevel::INFO);
+	const size_t iterations = 20000;
+	std::vector<std::thread> workers;
+	for (size_t i = 0; i < 4; ++i)
+		workers.emplace_back([&localLogger, i, iterations]() {
+			for (size_t index = i; index < iterations; index += 4)
+				localLogger.displayProgressBar(index, iterations);
+		});
+	for (std::thread& worker : workers)
+		worker.join();
+
+	// Reports of other threads, waiting for the bar to be drawn after each one
+	const auto reportFromThread = [&localLogger](size_t index, size_t total) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(120));
+		std::thread([&localLogger, index, total]() { localLogger.displayProgressBar(index, total); }).join();
+	};
+	reportFromThread(0,   1000);
+	reportFromThread(499, 1000);
+	reportFromThread(9,   1000); // Late, the bar stays at half
+	reportFromThread(999, 1000);
+	reportFromThread(998, 1000); // After the end, does not start a new loop
+
+	// The next loop of the same size starts with its first iteration
+	for (size_t index = 0; index < 1000; ++index)
+		localLogger.displayProgressBar(index, 1000);
+
+	std::cout.rdbuf(original);
+
+	// Every loop is finished once, and its percentage never goes back
+	const std::string output = captured.str();
+	const std::regex  percentage("\\] +([0-9]+)% ");
+	std::vector<int>  finished;
+	int               previous = -1;
+	for (auto match = std::sregex_iterator(output.begin(), output.end(), percentage); match != std::sregex_iterator(); ++match) {
+		const int value = std::stoi((*match)[1]);
+		EXPECT_GE(value, previous);
+		previous = value;
+		if (value == 100) {
+			finished.push_back(value);
+			previous = -1;
+		}
+	}
+	EXPECT_EQ(finished.size(), 3u);
+}
+
+TEST(TinyLoggerTest, ElapsedTimeIsMeasuredPerThreadOrCategory) {
+	auto sink = std::make_shared<tl::MemorySink>(8);
+	logger.addSink(sink);
+	logger.setTimestampFormat(TimestampFormat::CTIME, TimestampPrecision::MILLISECONDS);
+
+	const auto milliseconds = [&sink](size_t line) {
+		std::smatch match;
+		const std::string text = sink->lines()[line];
+		EXPECT_TRUE(std::regex_search(text, match, std::regex(" \\+([0-9]+)\\.([0-9]{3}) s ")));
+		return std::stoi(match[1]) * 1000 + std::stoi(match[2]);
+	};
+
+	logger.logINFO("main 1");
+	std::thread([]() {
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		logger.logINFO("thread 1");
+	}).join();
+	logger.logINFO("main 2");
+
+	// The records of the other thread do not reset the time of this one
+	logger.setElapsedScope(ElapsedScope::CATEGORY);
+	logger.logINFO("main 3");
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	LOG_INFO_CAT(elapsed, "category 1");
+	logger.logINFO("main 4");
+
+	logger.setElapsedScope(ElapsedScope::THREAD);
+	logger.setTimestampFormat(TimestampFormat::CTIME);
+	logger.removeSink(sink);
+
+	ASSERT_EQ(sink->lines().size(), 6u);
+	EXPECT_EQ(milliseconds(1), 0);
+	EXPECT_GE(milliseconds(2), 20);
+	EXPECT_EQ(milliseconds(4), 0);
+	EXPECT_GE(milliseconds(5), 20);
+}
+
+TEST(TinyLoggerTest, FormatStringsRenderFieldsWithTheirSpec) {
+	auto sink = std::make_shared<tl::MemorySink>(4);
+
+	Logger localLogger(LogLevel::TRACE);
+	localLogger.clearSinks();
+	localLogger.addSink(sink);
+
+	auto logFormatted = [&localLogger](int value, double ratio, const std::string& name) {
+		localLogger.logINFO(TL_FORMAT_ARGUMENTS("v={} r={:.3f} n={:>5}| {{}} {:08.2f} {:x} {:*^7} {:c}", value, ratio, name, -ratio, 255, "mid", 65));
+	};
+
+	logFormatted(42, 3.14159, "bob");
+	localLogger.startAsync();
+	logFormatted(7, 0.5, "alice");
+	localLogger.flush();
+	localLogger.stopAsync();
+
+	// Deferred records are rendered by the backend with the same specs
+	const std::vector<std::string> lines = sink->lines();
+	ASSERT_EQ(lines.size(), 2u);
+	EXPECT_EQ(lines[0].substr(lines[0].find("v=")), "v=42 r=3.142 n=  bob| {} -0003.14 ff **mid** A\n");
+	EXPECT_EQ(lines[1].substr(lines[1].find("v=")), "v=7 r=0.500 n=alice| {} -0000.50 ff **mid** A\n");
+
+	LOG_INFOF("formatted with the macro: {} {:.1f}", 1, 2.0);
+}
+
+TEST(TinyLoggerTest, CrashHandlerWritesBufferedLines) {
+	const std::filesystem::path path = std::filesystem::temp_directory_path() / "tinylogger_crash.log";
+	std::filesystem::remove(path);
+
+	// The crash happens in a child process, started again from main
+	GTEST_FLAG_SET(death_test_style, "threadsafe");
+	EXPECT_EXIT({
+		tl::FileSinkOptions options;
+		options.flushInterval = std::chrono::hours(1);
+		options.flushLevel    = LogLevel::OFF;
+
+		logger.clearSinks();
+		logger.addSink(std::make_shared<tl::FileSink>(path, options));
+		tl::installCrashHandler();
+
+		LOG_INFO("buffered line ", 1);
+		LOG_ERROR("buffered line ", 2);
+		std::raise(SIGSEGV);
+	}, ::testing::KilledBySignal(SIGSEGV), "");
+
+	std::ifstream file(path, std::ios::binary);
+	const std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	EXPECT_NE(content.find("buffered line 1\n"), std::string::npos);
+	EXPECT_NE(content.find("buffered line 2\n"), std::string::npos);
+	EXPECT_NE(content.find("Received signal SIGSEGV\n"), std::string::npos);
+	std::filesystem::remove(path);
+}
+
+TEST(TinyLoggerTest, CrashHandlerWritesQueuedRecords) {
+	const std::filesystem::path directory = std::filesystem::temp_directory_path() / "tinylogger_crash_queues";
+	std::filesystem::remove_all(directory);
+	std::filesystem::create_directories(directory);
+
+	// The backend sleeps once started, so that the records are still queued at the crash
+	GTEST_FLAG_SET(death_test_style, "threadsafe");
+	EXPECT_EXIT({
+		tl::MappedFileSinkOptions sinkOptions;
+		sinkOptions.segmentSize = 1 << 16;
+
+		logger.clearSinks();
+		logger.addSink(std::make_shared<tl::MappedFileSink>(directory / "crash.log", sinkOptions));
+		tl::installCrashHandler();
+
+		AsyncOptions options;
+		options.threadQueues = true;
+		options.backendSleep = std::chrono::hours(1);
+		logger.startAsync(options);
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+		std::thread([]() { LOG_INFO("queued by a thread ", 1); }).join();
+		LOG_INFOF("queued by main {} {:>6}", 2, "x");
+		LOG_INFO(std::string(3 * TINYLOGGER_FORMAT_BUFFER_SIZE, 'y'), " ends truncated");
+		std::raise(SIGSEGV);
+	}, ::testing::KilledBySignal(SIGSEGV), "");
+
+	std::ifstream file(directory / "crash.000001.log", std::ios::binary);
+	const std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	EXPECT_NE(content.find("queued by a thread 1\n"), std::string::npos);
+	EXPECT_NE(content.find("queued by main 2      x\n"), std::string::npos);
+	EXPECT_NE(content.find("yyyy\n"), std::string::npos);
+	EXPECT_EQ(content.find("ends truncated"), std::string::npos);
+	EXPECT_NE(content.find("Received signal SIGSEGV\n"), std::string::npos);
+	std::filesystem::remove_all(directory);
+}
+
+TEST(TinyLoggerTest, CrashFlushReachesQueuesOfThreadsAfterExitedOnes) {
+	// Blocks the backend on the line to block, and keeps the lines of the crash handler
+	class BlockingSink : public tl::Sink {
+	public:
+		void write(LogLevel, std::string_view line) override {
+			if (line.find("block") == std::string_view::npos)
+				return;
+			isBlocked = true;
+			while (!isReleased)
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+
+		void crashWrite(LogLevel, std::string_view line) override {
+			crashLines.emplace_back(line);
+		}
+
+		std::atomic<bool>        isBlocked{ false };
+		std::atomic<bool>        isReleased{ false };
+		std::vector<std::string> crashLines;
+	};
+
+	auto sink = std::make_shared<BlockingSink>();
+	Logger localLogger(LogLevel::TRACE);
+	localLogger.clearSinks();
+	localLogger.addSink(sink);
+	localLogger.prepareCrashFlush();
+
+	AsyncOptions options;
+	options.threadQueues = true;
+	localLogger.startAsync(options);
+
+	const auto waitForThreadQueues = [&localLogger](size_t count) {
+		for (int attempt = 0; attempt < 1000 && localLogger.stats().threadQueues != count; ++attempt)
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		ASSERT_EQ(localLogger.stats().threadQueues, count);
+	};
+
+	// Logs on a thread, then keeps it alive until mayExit is set
+	const auto startThread = [&localLogger](int i, std::promise<void>& mayExit) {
+		std::promise<void> logged;
+		std::future<void>  hasLogged = logged.get_future();
+		std::thread thread([&localLogger, logged = std::move(logged), exit = mayExit.get_future(), i]() mutable {
+			localLogger.logINFO("thread ", i);
+			logged.set_value();
+			exit.wait();
+		});
+		hasLogged.wait();
+		return thread;
+	};
+
+	// More exits than the crash handler has slots, each one of a queue listed before a live one
+	std::promise<void> mayExit;
+	std::thread previous = startThread(0, mayExit);
+	for (int i = 1; i <= 300; ++i) {
+		std::promise<void> nextMayExit;
+		std::thread next = startThread(i, nextMayExit);
+		mayExit.set_value();
+		previous.join();
+		waitForThreadQueues(1);
+		previous = std::move(next);
+		mayExit  = std::move(nextMayExit);
+	}
+
+	std::thread([&localLogger]() { localLogger.logINFO("block the backend"); }).join();
+	while (!sink->isBlocked)
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	std::thread([&localLogger]() { localLogger.logINFO("recovered by the crash handler"); }).join();
+
+	localLogger.crashFlush("crash flush called by the test");
+	sink->isReleased = true;
+	mayExit.set_value();
+	previous.join();
+	localLogger.stopAsync();
+
+	ASSERT_EQ(sink->crashLines.size(), 2u);
+	EXPECT_NE(sink->crashLines[0].find("recovered by the crash handler\n"), std::string::npos);
+	EXPECT_NE(sink->crashLines[1].find("crash flush called by the test\n"), std::string::npos);
+}
+
+TEST(TinyLoggerTest, StructuredRecordsAreEncodedAsJsonOrLogfmt) {
+	auto sink = std::make_shared<tl::MemorySink>(8);
+	logger.addSink(sink);
+
+	const std::string status = "served from the cache \"quoted\"\n";
+	auto logRequest = [&status]() {
+		LOG_INFO_KV("request done", tl::kv("latency_us", 42), tl::kv("status", status), tl::kv("ratio", 0.25), tl::kv("cached", true));
+	};
+
+	logRequest();
+	logger.setStructuredFormat(StructuredFormat::JSON);
+	logRequest();
+	logger.setStructuredFormat(StructuredFormat::LOGFMT);
+	logger.startAsync();
+	logRequest();
+	logger.flush();
+	logger.stopAsync();
+	logger.setStructuredFormat(StructuredFormat::TEXT);
+
+	logger.removeSink(sink);
+
+	// Only the function is part of the context, with the default flags
+	const std::vector<std::string> lines = sink->lines();
+	ASSERT_EQ(lines.size(), 3u);
+	EXPECT_EQ(lines[0].substr(lines[0].find(" s ") + 3),
+	          "operator(): request done latency_us=42 status=\"served from the cache \\\"quoted\\\"\\n\" ratio=0.25 cached=true\n");
+
+	const std::regex json(R"re(\{"time":"\d{4}-\d\d-\d\dT\d\d:\d\d:\d\dZ","level":"INFO","elapsed_us":\d+,)re"
+	                      R"re("function":"operator\(\)","message":"request done","latency_us":42,)re"
+	                      R"re("status":"served from the cache \\"quoted\\"\\n","ratio":0.25,"cached":true\}\n)re");
+	EXPECT_TRUE(std::regex_match(lines[1], json)) << lines[1];
+
+	const std::regex logfmt(R"re(time=\S+Z level=INFO elapsed_us=\d+ function=operator\(\) message="request done" )re"
+	                        R"re(latency_us=42 status="served from the cache \\"quoted\\"\\n" ratio=0.25 cached=true\n)re");
+	EXPECT_TRUE(std::regex_match(lines[2], logfmt)) << lines[2];
+}
+
+TEST(TinyLoggerTest, ConsoleSinkGathersLinesOfABatch) {
+	auto sink = std::make_shared<tl::ConsoleSink>();
+	Logger localLogger(LogLevel::TRACE);
+	localLogger.clearSinks();
+	localLogger.addSink(sink);
+
+	// Streams replaced after the sink is created are written through
+	std::ostringstream captured;
+	std::streambuf* originalCout = std::cout.rdbuf(captured.rdbuf());
+	std::streambuf* originalClog = std::clog.rdbuf(captured.rdbuf());
+	std::streambuf* originalCerr = std::cerr.rdbuf(captured.rdbuf());
+
+	// Every stream change writes the lines gathered before
+	localLogger.logINFO("first");
+	localLogger.startAsync();
+	for (int i = 0; i < 100; ++i)
+		localLogger.logINFO("record ", i);
+	localLogger.logERROR("error");
+	localLogger.logWARNING("warning");
+	localLogger.logINFO("last");
+	localLogger.flush();
+	localLogger.stopAsync();
+
+	std::cout.rdbuf(originalCout);
+	std::clog.rdbuf(originalClog);
+	std::cerr.rdbuf(originalCerr);
+
+	std::vector<std::string> messages;
+	std::istringstream lines(captured.str());
+	for (std::string line; std::getline(lines, line); )
+		messages.push_back(line.substr(line.find(" s ") + 3));
+	ASSERT_EQ(messages.size(), 104u);
+	EXPECT_EQ(messages[0],   "first");
+	EXPECT_EQ(messages[1],   "record 0");
+	EXPECT_EQ(messages[100], "record 99");
+	EXPECT_EQ(messages[101], "error");
+	EXPECT_EQ(messages[102], "warning");
+	EXPECT_EQ(messages[103], "last");
+
+	EXPECT_EQ(sink->writtenLines(), 104u);
+	EXPECT_LT(sink->writeCalls(), 50u);
+}
+
+TEST(TinyLoggerTest, StatsCountRecordsPerLevelAndSink) {
+	auto sink = std::make_shared<tl::MemorySink>(16);
+	Logger localLogger(LogLevel::INFO);
+	localLogger.clearSinks();
+	localLogger.addSink(sink);
+
+	localLogger.logINFO("info ", 1);
+	localLogger.logINFO("info ", 2);
+	static const tl::CallSite debugCallSite(LogLevel::DEBUG);
+	localLogger.logAt(debugCallSite, "disabled");
+
+	AsyncOptions options;
+	options.queueCapacity  = 4;
+	options.overflowPolicy = OverflowPolicy::DROP_NEWEST;
+	localLogger.startAsync(options);
+	for (int i = 0; i < 1000; ++i)
+		localLogger.logERROR("error ", i);
+	localLogger.flush();
+	localLogger.stopAsync();
+
+	const tl::LoggerStats stats = localLogger.stats();
+	EXPECT_EQ(stats[LogLevel::INFO].emitted,  2u);
+	EXPECT_EQ(stats[LogLevel::DEBUG].emitted, 0u);
+	EXPECT_EQ(stats[LogLevel::LERROR].emitted, 1000u);
+	EXPECT_EQ(stats[LogLevel::LERROR].dropped, localLogger.droppedRecords());
+	EXPECT_LE(stats.queueHighWaterMark, 4u);
+	ASSERT_EQ(stats.sinks.size(), 1u);
+	EXPECT_EQ(stats.sinks[0].name, "memory");
+	EXPECT_EQ(stats.sinks[0].records, 1002u - localLogger.droppedRecords());
+	EXPECT_EQ(stats.writeLatency.count, 1000u - localLogger.droppedRecords());
+	EXPECT_LE(stats.writeLatency.p50, stats.writeLatency.max);
+
+	// Calls discarded by the rate-limited macros are counted at their level
+	const uint64_t suppressed = logger.stats()[LogLevel::WARNING].suppressed;
+	for (int i = 0; i < 8; ++i)
+		LOG_WARNING_EVERY_N(4, "every fourth ", i);
+	EXPECT_EQ(logger.stats()[LogLevel::WARNING].suppressed - suppressed, 6u);
+
+	const std::string text = tl::prometheusText(stats);
+	EXPECT_NE(text.find("# TYPE tinylogger_records_emitted_total counter\n"), std::string::npos);
+	EXPECT_NE(text.find("tinylogger_records_emitted_total{level=\"INFO\"} 2\n"), std::string::npos);
+	EXPECT_NE(text.find("tinylogger_sink_records_total{sink=\"memory\",index=\"0\"} "), std::string::npos);
+	EXPECT_NE(text.find("tinylogger_backend_write_seconds{quantile=\"0.99\"} "), std::string::npos);
+}
+
+TEST(TinyLoggerTest, ThreadQueuesKeepTheRecordsOfExitedThreads) {
+	auto sink = std::make_shared<tl::MemorySink>(1024);
+	Logger localLogger(LogLevel::TRACE);
+	localLogger.clearSinks();
+	localLogger.addSink(sink);
+
+	AsyncOptions options;
+	options.threadQueues        = true;
+	options.threadQueueCapacity = 16;
+	options.numaShards          = 2;
+	localLogger.startAsync(options);
+
+	// Threads exit with records left in their queues
+	std::vector<std::thread> threads;
+	for (int t = 0; t < 4; ++t)
+		threads.emplace_back([&localLogger, t]() {
+			for (int i = 0; i < 200; ++i)
+				localLogger.logINFO("thread ", t, " record ", i);
+		});
+	for (std::thread& thread : threads)
+		thread.join();
+	localLogger.logINFO("main thread");
+	localLogger.flush();
+
+	tl::LoggerStats stats = localLogger.stats();
+	EXPECT_EQ(stats.queueCapacity, 16u);
+	EXPECT_LE(stats.queueHighWaterMark, 16u);
+	for (int attempt = 0; attempt < 1000 && stats.threadQueues > 1; ++attempt) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		stats = localLogger.stats();
+	}
+	EXPECT_EQ(stats.threadQueues, 1u);
+
+	localLogger.stopAsync();
+	localLogger.logINFO("synchronous");
+
+	// Every thread keeps its order, a queue being drained in order
+	const std::vector<std::string> lines = sink->lines();
+	ASSERT_EQ(lines.size(), 802u);
+	std::array<int, 4> next{};
+	for (size_t i = 0; i < 800; ++i) {
+		int thread = -1, record = -1;
+		ASSERT_EQ(std::sscanf(lines[i].substr(lines[i].find(" s ") + 3).c_str(), "thread %d record %d", &thread, &record), 2) << lines[i];
+		ASSERT_TRUE(thread >= 0 && thread < 4);
+		EXPECT_EQ(record, next[static_cast<size_t>(thread)]++);
+	}
+	EXPECT_NE(lines[800].find("main thread"), std::string::npos);
+	EXPECT_NE(lines[801].find("synchronous"), std::string::npos);
+}
+
+namespace {
+	// Not deferrable, so formatted by the producer
+	struct Point {
+		int x, y;
+	};
+
+	std::ostream& operator<<(std::ostream& stream, const Point& point) {
+		return stream << '(' << point.x << ", " << point.y << ')';
+	}
+}
+
+TEST(TinyLoggerTest, ArenaStoresLargeRecordsUntilItRunsOut) {
+	auto sink = std::make_shared<tl::MemorySink>(64);
+	Logger localLogger(LogLevel::TRACE);
+	localLogger.clearSinks();
+	localLogger.addSink(sink);
+
+	const std::string large(1000, 'x');
+	const std::string huge(5000, 'y');
+
+	AsyncOptions options;
+	options.arenaCapacity = 8192;
+	options.arenaSlabSize = 4096;
+	localLogger.startAsync(options);
+	localLogger.logINFO("large ", large);
+	localLogger.logINFO("point ", Point{ 1, 2 });
+	localLogger.logINFO("huge ", huge);
+	localLogger.flush();
+	localLogger.stopAsync();
+
+	tl::LoggerStats stats = localLogger.stats();
+	EXPECT_EQ(stats.arenaRecords,       2u);
+	EXPECT_EQ(stats.arenaHeapFallbacks, 1u);
+
+	// A single slab, that the backend cannot recycle while it sleeps
+	options.arenaCapacity = 4096;
+	options.arenaPolicy   = ArenaPolicy::DROP;
+	options.backendSleep  = std::chrono::milliseconds(200);
+	localLogger.startAsync(options);
+	for (int i = 0; i < 20; ++i)
+		localLogger.logINFO("record ", i, ' ', large);
+	localLogger.flush();
+	localLogger.stopAsync();
+
+	stats = localLogger.stats();
+	EXPECT_GT(stats.arenaDropped, 0u);
+	EXPECT_EQ(stats.arenaRecords - 2 + stats.arenaDropped, 20u);
+	EXPECT_EQ(stats[LogLevel::INFO].dropped, stats.arenaDropped);
+
+	const std::vector<std::string> lines = sink->lines();
+	ASSERT_EQ(lines.size(), 3 + 20 - stats.arenaDropped);
+	EXPECT_EQ(lines[0].substr(lines[0].find(" s ") + 3), "large " + large + "\n");
+	EXPECT_EQ(lines[1].substr(lines[1].find(" s ") + 3), "point (1, 2)\n");
+	EXPECT_EQ(lines[2].substr(lines[2].find(" s ") + 3), "huge " + huge + "\n");
+	EXPECT_EQ(lines[3].substr(lines[3].find(" s ") + 3), "record 0 " + large + "\n");
+}
+
+namespace {
+	struct Celsius {
+		double degrees;
+	};
+
+	enum class Color { RED = 1, GREEN = 2 };
+}
+
+template <>
+struct tl::formatter<Celsius> {
+	static constexpr bool isDeferrable = true;
+
+	static void format(tl::FormatBuffer& buffer, const Celsius& value) {
+		tl::formatter<double>::format(buffer, value.degrees);
+		buffer.append("C");
+	}
+};
+
+TEST(TinyLoggerTest, FormattersRenderBuiltInAndUserTypes) {
+	auto sink = std::make_shared<tl::MemorySink>(8);
+	Logger localLogger(LogLevel::TRACE);
+	localLogger.clearSinks();
+	localLogger.addSink(sink);
+
+	int         value   = 0;
+	const int*  pointer = nullptr;
+	const auto logTypes = [&]() {
+		localLogger.logINFO(Celsius{ 21.5 }, ' ', Color::GREEN, ' ', std::chrono::milliseconds(250), ' ',
+		                    std::chrono::duration<int, std::ratio<2, 3>>(4), ' ', pointer, ' ', nullptr);
+	};
+
+	logTypes();
+	pointer = &value;
+	localLogger.startAsync();
+	logTypes();
+	localLogger.logINFO(TL_FORMAT_ARGUMENTS("{:>8}|{}", Celsius{ -3 }, std::chrono::seconds(2)));
+	localLogger.flush();
+	localLogger.stopAsync();
+
+	const std::vector<std::string> lines = sink->lines();
+	ASSERT_EQ(lines.size(), 3u);
+	EXPECT_EQ(lines[0].substr(lines[0].find(" s ") + 3), "21.5C 2 250ms 4[2/3]s 0x0 nullptr\n");
+
+	std::ostringstream address;
+	address << static_cast<const void*>(&value);
+	EXPECT_EQ(lines[1].substr(lines[1].find(" s ") + 3), "21.5C 2 250ms 4[2/3]s " + address.str() + " nullptr\n");
+	EXPECT_EQ(lines[2].substr(lines[2].find(" s ") + 3), "     -3C|2s\n");
+
+	// Copied into the payload of the records, instead of formatted by the caller
+	EXPECT_TRUE((tl::detail::areDeferrable<Celsius, Color, std::chrono::milliseconds, const int*>));
+}
+
+TEST(TinyLoggerTest, BacktraceWritesRecentDisabledRecordsOnError) {
+	auto sink = std::make_shared<tl::MemorySink>(16);
+	Logger localLogger(LogLevel::INFO);
+	localLogger.clearSinks();
+	localLogger.addSink(sink);
+	localLogger.enableBacktrace(2, LogLevel::DEBUG);
+
+	static const tl::CallSite traceSite(LogLevel::TRACE);
+	static const tl::CallSite debugSite(LogLevel::DEBUG);
+	static const tl::CallSite infoSite(LogLevel::INFO);
+	static const tl::CallSite errorSite(LogLevel::LERROR);
+	EXPECT_TRUE(localLogger.isEnabled(debugSite));
+	EXPECT_FALSE(localLogger.isEnabled(traceSite));
+
+	for (int i = 0; i < 3; ++i)
+		localLogger.logAt(debugSite, "step ", i);
+	localLogger.logAt(infoSite, "served");
+	EXPECT_EQ(sink->lines().size(), 1u);
+
+	// Written before the error, and only once
+	localLogger.logAt(errorSite, "failed");
+	localLogger.logAt(errorSite, "failed again");
+
+	// Recorded by another thread, too large for the payload, and dumped on demand
+	const std::string large(300, 'w');
+	std::thread([&localLogger, &large]() {
+		localLogger.logAt(debugSite, "worker ", large);
+	}).join();
+	localLogger.dumpBacktrace();
+	localLogger.dumpBacktrace();
+
+	const std::vector<std::string> lines = sink->lines();
+	ASSERT_EQ(lines.size(), 6u);
+	EXPECT_EQ(lines[0].substr(lines[0].find(" s ") + 3), "served\n");
+	EXPECT_EQ(lines[1].substr(lines[1].find(" s ") + 3), "step 1\n");
+	EXPECT_EQ(lines[2].substr(lines[2].find(" s ") + 3), "step 2\n");
+	EXPECT_EQ(lines[3].substr(lines[3].find(" s ") + 3), "failed\n");
+	EXPECT_EQ(lines[4].substr(lines[4].find(" s ") + 3), "failed again\n");
+	EXPECT_EQ(lines[5].substr(lines[5].find(" s ") + 3), "worker " + large + "\n");
+	EXPECT_EQ(lines[1].rfind("[DEBUG", 0), 0u);
+
+	localLogger.disableBacktrace();
+	EXPECT_FALSE(localLogger.isEnabled(debugSite));
+}
+
+TEST(TinyLoggerTest, LevelsAreConfiguredFromTextAndWatchedFile) {
+	Logger localLogger(LogLevel::INFO);
+	EXPECT_TRUE(localLogger.configure(" warn , net=TRACE; db = 3 # comment, ignored=OFF\n"));
+	EXPECT_EQ(localLogger.logLevel(), LogLevel::WARNING);
+	EXPECT_EQ(localLogger.category("net").logLevel(), LogLevel::TRACE);
+	EXPECT_EQ(localLogger.category("db").logLevel(), LogLevel::WARNING);
+
+	// Nothing is applied when an entry is invalid
+	EXPECT_FALSE(localLogger.configure("DEBUG, net=LOUD"));
+	EXPECT_EQ(localLogger.logLevel(), LogLevel::WARNING);
+
+	const std::filesystem::path directory = std::filesystem::temp_directory_path() / "tinylogger_config";
+	const std::filesystem::path path      = directory / "levels.conf";
+	std::filesystem::remove_all(directory);
+	std::filesystem::create_directories(directory);
+	const auto writeFile = [&path](const std::string& content) {
+		const std::filesystem::path temporary = path.string() + ".tmp";
+		std::ofstream(temporary) << content;
+		std::filesystem::rename(temporary, path);
+	};
+	const auto waitFor = [](const std::function<bool()>& isDone) {
+		for (int i = 0; i < 500 && !isDone(); ++i)
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		return isDone();
+	};
+
+	writeFile("INFO\napi=DEBUG\n");
+	localLogger.watchConfig(path, std::chrono::milliseconds(10));
+	EXPECT_EQ(localLogger.logLevel(), LogLevel::INFO);
+	EXPECT_EQ(localLogger.category("api").logLevel(), LogLevel::DEBUG);
+
+	// Replaced as editors do, the category removed from the file gets the level of the logger
+	static const tl::CallSite debugSite(LogLevel::DEBUG);
+	EXPECT_FALSE(localLogger.isEnabled(debugSite));
+	writeFile("TRACE\n");
+	EXPECT_TRUE(waitFor([&]() { return localLogger.category("api").logLevel() == LogLevel::TRACE; }));
+	EXPECT_TRUE(localLogger.isEnabled(debugSite));
+
+	localLogger.stopWatchingConfig();
+	writeFile("ERROR\n");
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	EXPECT_EQ(localLogger.logLevel(), LogLevel::TRACE);
+	std::filesystem::remove_all(directory);
+}
+
+TEST(TinyLoggerTest, ArgumentPacksShareTheBackendAcrossCallSites) {
+	// Literals of any length, and references, decay to the same pack format
+	const tl::detail::PackFormat* shortLiteral = &tl::detail::packFormat<tl::detail::ArgumentType<const char(&)[4]>, int>;
+	const tl::detail::PackFormat* longLiteral  = &tl::detail::packFormat<tl::detail::ArgumentType<const char(&)[12]>, tl::detail::ArgumentType<const int&>>;
+	EXPECT_EQ(shortLiteral, longLiteral);
+
+	Logger localLogger(LogLevel::INFO);
+	auto sink = std::make_shared<tl::MemorySink>(8);
+	localLogger.clearSinks();
+	localLogger.addSink(sink);
+
+	const std::string owned("owned");
+	localLogger.log(LogLevel::WARNING, "one ", 1);
+	localLogger.log(LogLevel::INFO, "longer literal ", 2, ' ', owned);
+	localLogger.log(LogLevel::DEBUG, "filtered ", 3);
+	localLogger.log(LogLevel::OFF, "never written");
+	localLogger.log(static_cast<LogLevel>(42), "out of range");
+
+	const std::vector<std::string> lines = sink->lines();
+	ASSERT_EQ(lines.size(), 2u);
+	EXPECT_EQ(lines[0].substr(lines[0].find(" s ") + 3), "one 1\n");
+	EXPECT_EQ(lines[1].substr(lines[1].find(" s ") + 3), "longer literal 2 owned\n");
+	EXPECT_EQ(lines[1].rfind("[INFO", 0), 0u);
+}
@@ -0,0 +1,52 @@
+/*
+ * ============================================================================
+ *                          TinyLogger Decode Tool
+ * ============================================================================
+ *
+ * Prints a binary log, as written by tl::BinaryFileSink, as text lines.
+ *
+ * Usage: tinylogger_decode <binary log> [iso] [ms|us]
+ */
+
+
+#include <tinylogger/binary_decoder.hpp>
+
+#include <fstream>
+#include <iostream>
+#include <string>
+
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <binary log> [iso] [ms|us]" << std::endl;
+        return 2;
+    }
+
+    TimestampFormat    format    = TimestampFormat::CTIME;
+    TimestampPrecision precision = TimestampPrecision::SECONDS;
+    for (int i = 2; i < argc; ++i) {
+        const std::string option = argv[i];
+        if (option == "iso")
+            format = TimestampFormat::ISO8601;
+        else if (option == "ms")
+            precision = TimestampPrecision::MILLISECONDS;
+        else if (option == "us")
+            precision = TimestampPrecision::MICROSECONDS;
+        else {
+            std::cerr << "Unknown option: " << option << std::endl;
+            return 2;
+        }
+    }
+
+    std::ifstream input(argv[1], std::ios::binary);
+    if (!input) {
+        std::cerr << "Cannot open " << argv[1] << std::endl;
+        return 1;
+    }
+
+    if (!tl::decodeBinaryLog(input, std::cout, format, precision)) {
+        std::cerr << "Invalid or truncated binary log: " << argv[1] << std::endl;
+        return 1;
+    }
+    return 0;
+}